@@ -2,7 +2,17 @@
 #include "LCD.h"
 
 //--------------------- Code Section for LCD ------------------
+static int lcdGone = FALSE;     // stayed busy too long: unplugged
+
 //********************* LCD Initialization ********************
+// Busy wait on the core timer, not Timer1: Timer1 is the 1 ms tick
+// and may already be running.  initLCD() runs at the boot clock.
+static void waitLCD( unsigned us)
+{
+    unsigned t0 = _CP0_GET_COUNT();
+    while( _CP0_GET_COUNT() - t0 < us * CT_PER_US);
+} // waitLCD
+
 void initLCD( void)
 {
     // PMP initialization changed considerably!!!
@@ -10,36 +20,52 @@ void initLCD( void)
     PMMODE = 0x3FF;    // 8-bit, Master Mode 1, max wait states
 	PMAEN = 0x0001;    // only PMA0 enabled
     
-    // init TMR1
-    T1CON = 0x8030;    // Fpb/2, prescaled 1:256, 6us/tick
-
     // wait for >30ms
-    TMR1 = 0; while( TMR1<6000);// 6000 x 6us = 36ms   
+    waitLCD( 30000);
     
     //initiate the HD44780 display 8-bit init sequence
     PMADDR = LCDCMD;            // command register
     PMDATA = 0x38;              // 8-bit int, 2 lines, 5x7
-    TMR1 = 0; while( TMR1<8);   // 8 x 6us = 48us   
+    waitLCD( 48);
     
     PMDATA = 0x0c;              // disp.ON, no cursor, no blink
-    TMR1 = 0; while( TMR1<8);   // 8 x 6us = 48us   
+    waitLCD( 48);
     
     PMDATA = 1;                 // clear display
-    TMR1 = 0; while( TMR1<300); // 300 x 6us = 1.8ms   
+    waitLCD( 1800);
     
     PMDATA = 6;                 // increment cursor, no shift
-    TMR1 = 0; while( TMR1<300); // 300 x 6us = 1.8ms   
+    waitLCD( 1800);
 } // initLCD
 
 
+//************************** Ready LCD ************************
+// Every wait gives up after LCD_POLLS reads, a few ms at any clock.
+// A display still busy by then is taken to be unplugged and is left
+// alone until reset, so a loose cable can't hang the metronome.
+static void waitPMP( void)
+{
+    int n = LCD_POLLS;
+    while( PMMODEbits.BUSY && --n > 0);
+} // waitPMP
+
+static int readyLCD( void)
+{
+    int n = LCD_POLLS;
+    while( !lcdGone && busyLCD())
+        if( --n == 0) lcdGone = TRUE;
+    return( !lcdGone);
+} // readyLCD
+
 //************************** Read CLD *************************
 char readLCD( int addr)
 {
     int dummy;
-    while( PMMODEbits.BUSY);    // wait for PMP to be available
+    PMCONbits.ON = 1;           // PMP may have been idled
+    waitPMP();                  // wait for PMP to be available
     PMADDR = addr;              // select the command address
     dummy = PMDATA;             // init read cycle, dummy read
-    while( PMMODEbits.BUSY);    // wait for PMP to be available
+    waitPMP();                  // wait for PMP to be available
     return( PMDATA);            // read the status register
     
 } // readLCD
@@ -47,12 +73,20 @@ char readLCD( int addr)
 //************************* Write LCD *************************
 void writeLCD( int addr, char c)    
 {
-    while(busyLCD());
-    while(PMMODEbits.BUSY);    // wait for PMP to be available
+    if( !readyLCD()) return;
+    waitPMP();                 // wait for PMP to be available
     PMADDR = addr;
     PMDATA = c;
 } // writeLCD
    
+//************************** Idle LCD *************************
+void idleLCD( void)
+{
+    readyLCD();                 // let the last command finish
+    waitPMP();
+    PMCONbits.ON = 0;           // PMP off until the next access
+} // idleLCD
+
 //*************************** Put CLD *************************
 void putsLCD( char *s)
 {
@@ -28,6 +28,8 @@
 #define TRUE !FALSE
 #define FCY 72000000L
 #define FPB 36000000L
+#define CT_PER_US 40 // core timer counts per us, SYSCLK/2 at 80 MHz
+#define LCD_POLLS 1000 // busy reads before the display is given up on
 //**************************************************************
 
 //Initialize LCD
@@ -39,6 +41,9 @@ char readLCD( int addr);
 //Write to LCD
 void writeLCD( int addr, char c);
 
+//Turn the PMP off until the next LCD access
+void idleLCD( void);
+
 //Put character to LCD
 void putsLCD( char *s);
 
@@ -30,6 +30,8 @@
 #include "config.h"
 #include "MtrCtrl.h"
 #include "LCD.h"
+#include "battery.h"
+#include "soc.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -87,6 +89,8 @@ struct btn {
 
 volatile	struct btn	btnBtn1;
 volatile	struct btn	btnBtn2;
+volatile	WORD		btnDown = 0;	// debounced BUTTON_1/BUTTON_2 bits,
+										// one store per Timer5 pass
 BYTE stBtn1;
 BYTE stBtn2;
 char ans[5];
@@ -99,6 +103,7 @@ void	myWaitMs(WORD ms);
 void 	DelayUs( WORD tusDelay );
 BOOL 	ButtonPressed(WORD button);
 int 	ButtonPressed2(void);
+void	ReadButtons(void);
 void 	ClearAllLEDs(void);
 void	Wait_Ms(WORD ms, WORD displayControl);
 
@@ -153,6 +158,9 @@ void __ISR(_TIMER_5_VECTOR, ipl7) Timer5Handler(void)
 		btnBtn2.cst = 0;
 	}
 
+	// Publish both at once; readers need no interrupt masking.
+	btnDown = ( ( stPressed == btnBtn1.stBtn ) ? BUTTON_1 : 0 ) |
+		( ( stPressed == btnBtn2.stBtn ) ? BUTTON_2 : 0 );
 }
 
 /* ------------------------------------------------------------ */
@@ -204,26 +212,6 @@ char * intToString(long int num)
 }
 
 
-void initADC( int amask)
- {
- 	AD1PCFG = amask; // select analog input pins
- 	AD1CON1 = 0x00E0; // automatic conversion after sampling
- 	AD1CSSL = 0; // no scanning required
- 	AD1CON2 = 0; // use MUXA, use AVdd & AVss as Vref+/-
- 	AD1CON3 = 0x1F3F; // Tsamp = 32 x Tad;
- 	AD1CON1bits.ADON = 1; // turn on the ADC
-
- } //initADC
-
-int readADC( int ch)
-{
-	AD1CHSbits.CH0SA = ch; // 1. select input channel
-	AD1CON1bits.SAMP = 1; // 2. start sampling
- 	while (!AD1CON1bits.DONE); // 3. wait conversion
- 	return ADC1BUF0; // 4. read conversion result
-
-} // readADC
-
 /* ------------------------------------------------------------ */
 /***	DeviceInit
 **
@@ -474,29 +462,13 @@ BOOL StopMotor(WORD motor)
 **	Errors:
 **		none
 **	Description:
-**		Uses interrupts: ???
-**		Spin here until correct button pressed.
+**		Reads btnDown, one load per check.
+**		Spin here until correct button pressed, alone.
 */
 BOOL ButtonPressed(WORD button)	
 {	
-//	BYTE	stBtn1;
-//	BYTE	stBtn2;
-
-	INTDisableInterrupts();
-	stBtn1 = btnBtn1.stBtn;
-	stBtn2 = btnBtn2.stBtn;
-	INTEnableInterrupts();
-
-	if (button == BUTTON_1) {
-		while (((stReleased == btnBtn1.stBtn) && (stReleased == btnBtn2.stBtn)) ||
-		  ((stPressed == btnBtn1.stBtn) && (stPressed == btnBtn2.stBtn))    ||
-		  ((stReleased == btnBtn1.stBtn) && (stPressed == btnBtn2.stBtn))) { }
-	}
-
-	if (button == BUTTON_2) {
-		while (((stReleased == btnBtn1.stBtn) && (stReleased == btnBtn2.stBtn)) ||
-		  ((stPressed == btnBtn1.stBtn) && (stPressed == btnBtn2.stBtn))    ||
-		  ((stPressed == btnBtn1.stBtn) && (stReleased == btnBtn2.stBtn))) { }
+	if (button == BUTTON_1 || button == BUTTON_2) {
+		while (btnDown != button) { }
 	}
 
 	return fTrue;	
@@ -505,27 +477,42 @@ BOOL ButtonPressed(WORD button)
 
 int ButtonPressed2(void)	
 {	
-	BYTE	stBtn1;
-	BYTE	stBtn2;
-
-	INTDisableInterrupts();
-	stBtn1 = btnBtn1.stBtn;
-	stBtn2 = btnBtn2.stBtn;
-	INTEnableInterrupts();
+	WORD	btn;
 
     while(1)
 	{
-		if((stPressed == btnBtn1.stBtn) && (stReleased == btnBtn2.stBtn)) {
+		btn = btnDown;
+		if(btn == BUTTON_1) {
             Delayms(400);
 			return 1;
 		}
-		if((stReleased == btnBtn1.stBtn) && (stPressed == btnBtn2.stBtn)) {
+		if(btn == BUTTON_2) {
             Delayms(400);
 			return 2;
 		}
 	}
 }
 
+/* ------------------------------------------------------------ */
+/*	ReadButtons(void)
+**	Parameters:
+**		none
+**	Return Values:
+**		none
+**	Errors:
+**		none
+**	Description:
+**		stBtn1 and stBtn2 from one load of btnDown, so the pair
+**		always comes from the same Timer5 pass.
+*/
+void ReadButtons(void)
+{
+	WORD	btn = btnDown;
+
+	stBtn1 = ( btn & BUTTON_1 ) ? stPressed : stReleased;
+	stBtn2 = ( btn & BUTTON_2 ) ? stPressed : stReleased;
+}
+
 /* ------------------------------------------------------------ */
 /*  ClearAllLEDs(void)
 **	Parameters:
@@ -560,7 +547,8 @@ void ClearAllLEDs(void)
 int main(void) 
 {
    	// initializations
-   	initADC(4);
+   	BattInit();
+   	SocInit(SOC_ALKALINE);
    	initLCD();
    	DeviceInit();
 	INTEnableSystemMultiVectoredInt();
@@ -580,8 +568,10 @@ int main(void)
 	unsigned int control1 = 0;
 	WORD startUp = 0;
 
-	//strcat(battery, intToString((readADC(8))));
-	strcat(battery, intToString((readADC(8) / 4) - 6));
+	// first 16-sample battery burst finishes in a few ms
+	while(!BattReady());
+	SocTask();
+	strcat(battery, intToString(SocGetPercent()));
 	strcat(battery, "%");
 
 	cmdLCD(0x00 | 0x00);
@@ -645,20 +635,14 @@ int main(void)
 
 					while(delay > 0)
 					{	
-						INTDisableInterrupts();
-						stBtn1 = btnBtn1.stBtn;
-						stBtn2 = btnBtn2.stBtn;
-						INTEnableInterrupts();
+						ReadButtons();
 
 						if(!((stPressed == stBtn2) && (stReleased == stBtn1)) || !((stPressed == stBtn1) && (stReleased == stBtn2)))
 						{
 							WORD i;
 							for( i = 0; i < 375; i ++)
 							{
-								INTDisableInterrupts();
-								stBtn1 = btnBtn1.stBtn;
-								stBtn2 = btnBtn2.stBtn;
-								INTEnableInterrupts();
+								ReadButtons();
 
 								if(((stPressed == stBtn2) && (stReleased == stBtn1)) || ((stPressed == stBtn1) && (stReleased == stBtn2)))
 								{
@@ -686,20 +670,14 @@ int main(void)
 
 					while(delay > 0)
 					{
-						INTDisableInterrupts();
-						stBtn1 = btnBtn1.stBtn;
-						stBtn2 = btnBtn2.stBtn;
-						INTEnableInterrupts();
+						ReadButtons();
 
 						if(!((stPressed == stBtn2) && (stReleased == stBtn1)) || !((stPressed == stBtn1) && (stReleased == stBtn2)))
 						{
 							WORD i;
 							for( i = 0; i < 375; i ++)
 							{
-								INTDisableInterrupts();
-								stBtn1 = btnBtn1.stBtn;
-								stBtn2 = btnBtn2.stBtn;
-								INTEnableInterrupts();
+								ReadButtons();
 
 								if(((stPressed == stBtn2) && (stReleased == stBtn1)) || ((stPressed == stBtn1) && (stReleased == stBtn2)))
 								break;
@@ -716,10 +694,7 @@ int main(void)
 				}
 			}
 
-			INTDisableInterrupts();
-			stBtn1 = btnBtn1.stBtn;
-			stBtn2 = btnBtn2.stBtn;
-			INTEnableInterrupts();
+			ReadButtons();
 
 			// Stop motor
 			if ((stPressed == stBtn2) && (stReleased == stBtn1))
@@ -0,0 +1,125 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-IMA-ADPCM block decoder for the click sample bank.  Plain C  *
+ *				 so tools/wav2bank can build it on the host too.              *
+ ******************************************************************************/
+
+#include "stdtypes.h"
+#include "adpcm.h"
+
+/* ------------------------------------------------------------ */
+/*				Global Variables								*/
+/* ------------------------------------------------------------ */
+const HWORD rgstepAdpcm[ADPCM_STEPS] = {
+	    7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+	   19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+	   50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+	  130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+	  337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+	  876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+	 2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+	 5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767 };
+
+const int8_t rgidxAdpcm[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8 };
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static WORD RdHword(const BYTE *pb)
+{
+	return pb[0] | ( pb[1] << 8 );
+}
+
+static WORD RdWord(const BYTE *pb)
+{
+	return RdHword(pb) | ( RdHword(pb + 2) << 16 );
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+WORD AdpcmCount(const BYTE *pbBank)
+{
+	if (pbBank[0] != 'M' || pbBank[1] != 'B' || pbBank[2] != 'N' || pbBank[3] != 'K')
+		return 0;
+	if (RdHword(pbBank + 4) != ADPCM_VERSION)
+		return 0;
+	return RdHword(pbBank + 6);
+}
+
+BOOL AdpcmStart(struct adpcm *pst, const BYTE *pbBank, WORD ent)
+{
+	const BYTE	*pbEnt;
+
+	if (ent >= AdpcmCount(pbBank))
+		return fFalse;
+
+	pbEnt = pbBank + ADPCM_HDR_SIZE + ent * ADPCM_ENT_SIZE;
+	pst->pb = pbBank + RdWord(pbEnt);
+	pst->csmp = RdWord(pbEnt + 4);
+	pst->pred = (int16_t)RdHword(pbEnt + 8);
+	pst->idx = pbEnt[10];
+	pst->fHi = fFalse;
+	return fTrue;
+}
+
+int16_t AdpcmNibble(int16_t pred, BYTE *pidx, BYTE nib)
+{
+	int		step = rgstepAdpcm[*pidx];
+	int		diff = step >> 3;
+	int		val;
+	int		idx;
+
+	if (nib & 4)
+		diff += step;
+	if (nib & 2)
+		diff += step >> 1;
+	if (nib & 1)
+		diff += step >> 2;
+
+	val = ( nib & 8 ) ? pred - diff : pred + diff;
+	if (val > 32767)
+		val = 32767;
+	if (val < -32768)
+		val = -32768;
+
+	idx = *pidx + rgidxAdpcm[nib];
+	if (idx < 0)
+		idx = 0;
+	if (idx > ADPCM_STEPS - 1)
+		idx = ADPCM_STEPS - 1;
+	*pidx = idx;
+
+	return val;
+}
+
+//PWM duty is the top 8 bits of the sample, offset to mid-scale
+WORD AdpcmDecode(struct adpcm *pst, HWORD *pdtc, WORD cdtc)
+{
+	WORD	cdone;
+	BYTE	nib;
+
+	if (cdtc > pst->csmp)
+		cdtc = pst->csmp;
+
+	for (cdone = 0; cdone < cdtc; cdone++) {
+		if (pst->fHi) {
+			nib = *pst->pb++ >> 4;
+			pst->fHi = fFalse;
+		}
+		else {
+			nib = *pst->pb & 0xF;
+			pst->fHi = fTrue;
+		}
+		pst->pred = AdpcmNibble(pst->pred, &pst->idx, nib);
+		*pdtc++ = ( pst->pred >> 8 ) + 128;
+	}
+
+	pst->csmp -= cdtc;
+	return cdtc;
+}
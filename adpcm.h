@@ -0,0 +1,72 @@
+/************************************************************************/
+/*																		*/
+/*	adpcm.h -- IMA-ADPCM sample bank format and decoder					*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	A sample bank is one byte array in flash, built on the host by		*/
+/*	tools/wav2bank.  All fields are little endian:						*/
+/*																		*/
+/*	  0	 'M' 'B' 'N' 'K'												*/
+/*	  4	 version (HWORD), number of samples (HWORD)						*/
+/*	  8	 sample rate in Hz (HWORD), reserved (HWORD)					*/
+/*	 12	 one 12-byte entry per sample:									*/
+/*		   data offset from bank start (WORD), sample count (WORD),		*/
+/*		   initial predictor (int16), initial step index (BYTE), pad	*/
+/*	 ..	 4-bit IMA-ADPCM codes, low nibble first						*/
+/*																		*/
+/*	The decoder works in blocks and keeps its state in struct adpcm,	*/
+/*	so a sample can be decoded a few dozen samples at a time.			*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_ADPCM_INC)
+#define _ADPCM_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	ADPCM_VERSION		1
+#define	ADPCM_HDR_SIZE		12
+#define	ADPCM_ENT_SIZE		12
+#define	ADPCM_STEPS			89
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+struct adpcm {
+	const BYTE	*pb;		// next code byte
+	WORD		csmp;		// samples left
+	int16_t		pred;		// last decoded sample
+	BYTE		idx;		// step table index
+	BYTE		fHi;		// next code is the high nibble
+};
+
+/* ------------------------------------------------------------ */
+/*					Variable Declarations						*/
+/* ------------------------------------------------------------ */
+
+extern const HWORD	rgstepAdpcm[ADPCM_STEPS];
+extern const int8_t	rgidxAdpcm[16];
+
+extern const BYTE	rgbBank[];			// bank.c, generated
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+WORD	AdpcmCount(const BYTE *pbBank);
+BOOL	AdpcmStart(struct adpcm *pst, const BYTE *pbBank, WORD ent);
+//decode up to cdtc samples as 8-bit PWM duty values; returns the count
+WORD	AdpcmDecode(struct adpcm *pst, HWORD *pdtc, WORD cdtc);
+//one code step; shared with the encoder in tools/wav2bank
+int16_t	AdpcmNibble(int16_t pred, BYTE *pidx, BYTE nib);
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,268 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-audio click engine.  Clicks are IMA-ADPCM in the flash       *
+ *				 sample bank; the DMA ISR decodes them a half ring at a time  *
+ *				 while DMA streams the other half into the OC4 PWM duty.      *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "config.h"
+#include "stdtypes.h"
+#include "power.h"
+#include "adpcm.h"
+#include "audio.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		bnON				15
+#define		bnTCKPS				4
+#define		bnOCTSEL			3			// OC4CON: Timer3 time base
+#define		OCM_PWM				6			// PWM, fault pin disabled
+#define		AUDIO_PWM_PR		255			// 8-bit duty
+#define		bnCHEN				7			// DCH0CON
+#define		bnCHAEN				4			// DCH0CON: re-arm after each block
+#define		bnSIRQEN			4			// DCH0ECON
+#define		bnCHSHIF			6			// DCH0INT: source half empty
+#define		bnCHBCIF			3			// DCH0INT: block transfer done
+#define		bnCHSHIE			22
+#define		bnCHBCIE			19
+#define		bnDMAON				15			// DMACON
+
+// The DMA source size register is 8 bits, so the whole ring must stay
+// under 256 bytes.  60 samples is 7.5 ms of sound per half.
+#define		AUDIO_HALF			60
+
+#define		PH_IDLE				0
+#define		PH_ATTACK			1			// playing the RAM attack buffer
+#define		PH_RING				2			// playing the decode ring
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+// first half-ring of every wave, decoded at init so a click can start
+// from the beat ISR without decoding anything there
+static HWORD		rgdtcAttack[AUDIO_WAVES][AUDIO_HALF];
+static HWORD		rgcdtcAttack[AUDIO_WAVES];
+static struct adpcm	rgstAttack[AUDIO_WAVES];	// decoder state after the attack
+static WORD			cwave = 0;
+
+static HWORD		rgdtcRing[2 * AUDIO_HALF];
+static struct adpcm	stPlay;
+static volatile BYTE	audReq = 0;		// wave + 1 waiting for the ISR
+static volatile BYTE	audPhase = PH_IDLE;
+static BYTE			audEnd = 0;			// ring half + 1 holding the last sample
+
+static BOOL	fAudioOn = fFalse;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+//Between clicks the carrier is stopped too, or it would hum through
+// the speaker.  The pin floats rather than dropping to ground, so the
+// output filter stays near mid-rail and the next click starts
+// without a thump.
+static void AudioStop(void)
+{
+	DCH0CONCLR = ( 1 << bnCHEN ) | ( 1 << bnCHAEN );
+	T4CONCLR = ( 1 << bnON );
+	trisOC4Set = ( 1 << bnOC4 );
+	OC4CONCLR = ( 1 << bnON );
+	T3CONCLR = ( 1 << bnON );
+	OC4R = AUDIO_SILENCE;
+	OC4RS = AUDIO_SILENCE;
+	audPhase = PH_IDLE;
+}
+
+//decode into one ring half, padding with silence past the end
+static void AudioFill(WORD half)
+{
+	HWORD	*pdtc = &rgdtcRing[half * AUDIO_HALF];
+	WORD	cdtc;
+
+	cdtc = AdpcmDecode(&stPlay, pdtc, AUDIO_HALF);
+	if (cdtc < AUDIO_HALF && audEnd == 0)
+		audEnd = half + 1;
+	while (cdtc < AUDIO_HALF)
+		pdtc[cdtc++] = AUDIO_SILENCE;
+}
+
+//a half has been sent: stop if it held the end, otherwise refill it
+static void AudioRefill(WORD half)
+{
+	unsigned	st;
+
+	if (audEnd == half + 1) {
+		st = INTDisableInterrupts();
+		if (audReq == 0)
+			AudioStop();
+		INTRestoreInterrupts(st);
+		return;
+	}
+	AudioFill(half);
+}
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Service Routines						*/
+/* ------------------------------------------------------------ */
+
+//Runs below the beat ISR, which may start a new click at any point
+// in here.  DMA registers are only touched with interrupts off and
+// no request pending; a new request re-raises this interrupt.
+void __ISR(_DMA_0_VECTOR, ipl3) AudioDmaHandler(void)
+{
+	WORD		flags;
+	WORD		wave;
+	unsigned	st;
+
+	flags = DCH0INT;
+	DCH0INTCLR = 0xFF;
+	IFS1CLR = ( 1 << 16 );
+
+	// new click: its attack is already playing, queue up the rest
+	if (audReq != 0) {
+		wave = audReq - 1;
+		audReq = 0;
+		stPlay = rgstAttack[wave];
+		audEnd = 0;
+		AudioFill(0);
+		AudioFill(1);
+		return;
+	}
+
+	if (audPhase == PH_ATTACK) {
+		if (flags & ( 1 << bnCHBCIF )) {
+			st = INTDisableInterrupts();
+			if (audReq == 0) {
+				DCH0SSA = KVA_TO_PA(rgdtcRing);
+				DCH0SSIZ = sizeof(rgdtcRing);
+				DCH0INTCLR = 0xFF;
+				DCH0CONSET = ( 1 << bnCHAEN ) | ( 1 << bnCHEN );
+				audPhase = PH_RING;
+			}
+			INTRestoreInterrupts(st);
+		}
+		return;
+	}
+
+	if (audPhase == PH_RING) {
+		if (flags & ( 1 << bnCHSHIF ))
+			AudioRefill(0);
+		if (flags & ( 1 << bnCHBCIF ))
+			AudioRefill(1);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void AudioInit(void)
+{
+	WORD	wave;
+
+	// decode every attack now, while there is time to spare
+	cwave = AdpcmCount(rgbBank);
+	if (cwave > AUDIO_WAVES)
+		cwave = AUDIO_WAVES;
+	for (wave = 0; wave < cwave; wave++) {
+		AdpcmStart(&rgstAttack[wave], rgbBank, wave);
+		rgcdtcAttack[wave] = AdpcmDecode(&rgstAttack[wave], rgdtcAttack[wave], AUDIO_HALF);
+	}
+
+	// PWM carrier: Timer3 at PBCLK, 256 steps, so 39 kHz at PWR_FULL
+	// and 19.5 kHz at the slower levels, which power.c keeps at 5 MHz
+	// PBCLK for this.  Only runs while a click plays.
+	T3CON = 0;
+	TMR3 = 0;
+	PR3 = AUDIO_PWM_PR;
+	OC4CON = ( 1 << bnOCTSEL ) | OCM_PWM;
+	OC4R = AUDIO_SILENCE;
+	OC4RS = AUDIO_SILENCE;
+	trisOC4Set = ( 1 << bnOC4 );
+
+	// sample clock: Timer4 on the 2.5 MHz tick, only its flag is used
+	T4CON = 0;
+	PR4 = AUDIO_SAMPLE_PR;
+	IFS0CLR = ( 1 << 16 );
+
+	// DMA channel 0: one 2-byte cell into OC4RS per Timer4 period
+	DMACONSET = ( 1 << bnDMAON );
+	DCH0CON = 3;								// highest channel priority
+	DCH0ECON = ( _TIMER_4_IRQ << 8 ) | ( 1 << bnSIRQEN );
+	DCH0DSA = KVA_TO_PA(&OC4RS);
+	DCH0DSIZ = sizeof(HWORD);
+	DCH0CSIZ = sizeof(HWORD);
+	DCH0INTCLR = 0x00FF00FF;
+	DCH0INTSET = ( 1 << bnCHSHIE ) | ( 1 << bnCHBCIE );
+
+	// DMA0 interrupt, priority level 3
+	IPC9CLR = ( 7 << 2 ) | ( 3 << 0 );
+	IPC9SET = ( 3 << 2 );
+	IFS1CLR = ( 1 << 16 );
+	IEC1SET = ( 1 << 16 );
+}
+
+void AudioEnable(BOOL fOn)
+{
+	fAudioOn = fOn;
+
+	if (!fOn)
+		AudioStop();
+}
+
+//Starts the RAM attack buffer at once and leaves the decoding to the
+// DMA ISR.  Restarting the sample clock here lines the first sample
+// up one sample period after the call.
+void AudioPlay(WORD wave)
+{
+	if (!fAudioOn || wave >= cwave || rgcdtcAttack[wave] == 0)
+		return;
+
+	DCH0CONCLR = ( 1 << bnCHEN ) | ( 1 << bnCHAEN );
+	T4CONCLR = ( 1 << bnON );
+
+	// carrier back on at mid-rail; the first sample is a period away
+	T3CONSET = ( 1 << bnON );
+	OC4CONSET = ( 1 << bnON );
+	trisOC4Clr = ( 1 << bnOC4 );
+
+	DCH0SSA = KVA_TO_PA(rgdtcAttack[wave]);
+	DCH0SSIZ = rgcdtcAttack[wave] * sizeof(HWORD);
+	DCH0INTCLR = 0xFF;
+	DCH0CONSET = ( 1 << bnCHEN );
+	audPhase = PH_ATTACK;
+	audReq = wave + 1;
+	IFS1SET = ( 1 << 16 );
+
+	TMR4 = 0;
+	IFS0CLR = ( 1 << 16 );
+	T4CON = ( PowerGetBeatCkps() << bnTCKPS );
+	T4CONSET = ( 1 << bnON );
+}
+
+#if defined(ADPCM_BENCH)
+//Decodes the whole bank once and returns core cycles per sample,
+// times 10.  The core timer counts at half the system clock.
+WORD AudioBenchCycles(void)
+{
+	struct adpcm	st;
+	HWORD	rgdtc[AUDIO_HALF];
+	WORD	csmp = 0;
+	WORD	tcStart;
+	WORD	tc;
+	WORD	wave;
+	WORD	cdtc;
+
+	tcStart = ReadCoreTimer();
+	for (wave = 0; wave < AdpcmCount(rgbBank); wave++) {
+		AdpcmStart(&st, rgbBank, wave);
+		while ((cdtc = AdpcmDecode(&st, rgdtc, AUDIO_HALF)) != 0)
+			csmp += cdtc;
+	}
+	tc = ReadCoreTimer() - tcStart;
+
+	return csmp ? ( tc * 20 ) / csmp : 0;
+}
+#endif
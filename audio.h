@@ -0,0 +1,55 @@
+/************************************************************************/
+/*																		*/
+/*	audio.h -- Wavetable click generator								*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	OC4 (RD3) runs as an 8-bit PWM on Timer3.  DMA channel 0 copies		*/
+/*	duty values into OC4RS, one sample per Timer4 period.  Timer4 runs	*/
+/*	from the same 2.5 MHz tick as the beat engine, so the sample rate	*/
+/*	stays fixed at every power level.									*/
+/*																		*/
+/*	The waves are IMA-ADPCM in the sample bank (adpcm.h, bank.c).		*/
+/*	The first few milliseconds of each are decoded into RAM at init,	*/
+/*	so the beat interrupt starts a click with no decoding and the		*/
+/*	sound starts a fixed time after the beat.  The DMA interrupt then	*/
+/*	decodes the rest into a two-half ring while the other half plays.	*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_AUDIO_INC)
+#define _AUDIO_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	AUDIO_SAMPLE_PR		312			// 2.5 MHz / 313 = 7987 Hz
+#define	AUDIO_SILENCE		128			// PWM duty at rest
+
+// sample bank order, see tools/wav2bank
+#define	AUDIO_CLICK			0
+#define	AUDIO_ACCENT		1
+#define	AUDIO_WOODBLOCK		2
+#define	AUDIO_COWBELL		3
+#define	AUDIO_WAVES			4
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	AudioInit(void);
+void	AudioEnable(BOOL fOn);
+//start a click now; safe to call from an ISR
+void	AudioPlay(WORD wave);
+#if defined(ADPCM_BENCH)
+//decode cycles per sample, times 10
+WORD	AudioBenchCycles(void);
+#endif
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,103 @@
+/* Generated by tools/wav2bank -- do not edit.
+** in tools/wav: ../wav2bank ../../bank.c click.wav accent.wav woodblock.wav cowbell.wav
+** 7987 Hz, 1079 bytes (4068 bytes as 16-bit PCM):
+**   0: click.wav, 119 samples
+**   1: accent.wav, 159 samples
+**   2: woodblock.wav, 319 samples
+**   3: cowbell.wav, 1437 samples
+*/
+
+#include "stdtypes.h"
+#include "adpcm.h"
+
+const BYTE rgbBank[1079] = {
+	0x4D, 0x42, 0x4E, 0x4B, 0x01, 0x00, 0x04, 0x00, 0x33, 0x1F, 0x00, 0x00,
+	0x3C, 0x00, 0x00, 0x00, 0x77, 0x00, 0x00, 0x00, 0xDD, 0xEE, 0x00, 0x00,
+	0x78, 0x00, 0x00, 0x00, 0x9F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0xC8, 0x00, 0x00, 0x00, 0x3F, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x68, 0x01, 0x00, 0x00, 0x9D, 0x05, 0x00, 0x00, 0xB0, 0xB9, 0x00, 0x00,
+	0x70, 0xF7, 0x7F, 0x77, 0xFF, 0x36, 0xE9, 0x28, 0x82, 0x8B, 0x32, 0xD9,
+	0x28, 0x01, 0x8B, 0x32, 0xBA, 0x38, 0xA2, 0x9B, 0x53, 0xD8, 0x28, 0x91,
+	0x89, 0x31, 0xAA, 0x49, 0x91, 0x8B, 0x14, 0xA9, 0x28, 0xA3, 0x9B, 0x43,
+	0xAA, 0x39, 0xA4, 0x0B, 0x32, 0xBB, 0x59, 0x92, 0x0C, 0x12, 0xB9, 0x30,
+	0x91, 0x8B, 0x33, 0xBC, 0x30, 0xA3, 0x9C, 0x15, 0xAA, 0x30, 0xA1, 0x0A,
+	0x70, 0xFF, 0xA7, 0x7F, 0xF7, 0x72, 0xCD, 0x97, 0x5A, 0x99, 0x01, 0x99,
+	0xA5, 0x39, 0x99, 0x02, 0x99, 0xA4, 0x5A, 0x99, 0x01, 0x89, 0xA3, 0x5A,
+	0x99, 0x02, 0x8A, 0xA4, 0x5A, 0x99, 0x01, 0x89, 0xA3, 0x5A, 0x99, 0x01,
+	0x89, 0xA3, 0x6A, 0x99, 0x01, 0x89, 0xA3, 0x6B, 0x99, 0x82, 0x89, 0xA3,
+	0x5A, 0x99, 0x82, 0x89, 0xA3, 0x6A, 0x99, 0x82, 0x89, 0xA3, 0x5A, 0xA9,
+	0x83, 0x89, 0xA3, 0x6A, 0x9A, 0x83, 0x0A, 0xA3, 0x5A, 0xA9, 0x83, 0x0A,
+	0xA3, 0x7B, 0x99, 0x82, 0x09, 0x91, 0x5A, 0x09, 0x70, 0x77, 0xFF, 0xFF,
+	0x8F, 0x77, 0xC8, 0x09, 0x91, 0x40, 0x84, 0xAD, 0x10, 0x81, 0x21, 0xC1,
+	0x9C, 0x32, 0x91, 0x10, 0xE9, 0x0A, 0x25, 0xA8, 0x80, 0xB9, 0x59, 0x04,
+	0xB9, 0x00, 0x9A, 0x61, 0x92, 0xAB, 0x10, 0x88, 0x63, 0xB0, 0x8D, 0x12,
+	0x08, 0x12, 0xEA, 0x1A, 0x23, 0x09, 0x81, 0xCC, 0x48, 0x03, 0x8A, 0x90,
+	0x9C, 0x62, 0x91, 0x8A, 0x90, 0x1A, 0x44, 0xB8, 0x0B, 0x81, 0x28, 0x16,
+	0xCB, 0x19, 0x02, 0x28, 0x93, 0xBF, 0x21, 0x02, 0x19, 0xC1, 0x9C, 0x53,
+	0x90, 0x88, 0xB0, 0x1B, 0x27, 0xB8, 0x88, 0xA0, 0x48, 0x04, 0xBB, 0x18,
+	0x90, 0x61, 0xA2, 0xAC, 0x30, 0x80, 0x31, 0xE0, 0x8B, 0x33, 0x88, 0x10,
+	0xFA, 0x2A, 0x14, 0x98, 0x08, 0xCA, 0x40, 0x84, 0x9A, 0x08, 0x99, 0x62,
+	0x91, 0x9C, 0x01, 0x08, 0x33, 0xE8, 0x0B, 0x12, 0x18, 0x12, 0xDC, 0x29,
+	0x03, 0x08, 0x91, 0xBD, 0x51, 0x82, 0x0A, 0xA0, 0x8C, 0x63, 0x90, 0x8A,
+	0x90, 0x19, 0x35, 0xD9, 0x09, 0x81, 0x28, 0x04, 0xBC, 0x28, 0x01, 0x38,
+	0xB2, 0xAF, 0x31, 0x92, 0x10, 0xC8, 0x8C, 0x34, 0x98, 0x19, 0xC9, 0x0A,
+	0x70, 0x77, 0x77, 0x77, 0x0D, 0x76, 0x03, 0x28, 0x8A, 0x80, 0x57, 0xE8,
+	0xC0, 0x80, 0x80, 0x17, 0x08, 0xB8, 0x90, 0x8A, 0x04, 0x80, 0x20, 0x0B,
+	0x08, 0x07, 0x8C, 0xB0, 0x89, 0x80, 0x47, 0x08, 0xB8, 0xC8, 0x08, 0x04,
+	0x08, 0xB2, 0x80, 0x80, 0x16, 0x8D, 0xC0, 0x08, 0x40, 0x03, 0x80, 0xE0,
+	0xB8, 0x08, 0x85, 0x80, 0xB5, 0x08, 0x08, 0xB5, 0x08, 0xD8, 0x80, 0x40,
+	0x03, 0x08, 0xD8, 0x0C, 0x08, 0x84, 0x80, 0xB5, 0x08, 0x08, 0xB5, 0x08,
+	0xD8, 0x80, 0x04, 0x03, 0x88, 0xE0, 0x0B, 0x08, 0x04, 0x58, 0xB8, 0x80,
+	0x08, 0xB6, 0x08, 0xC8, 0x80, 0x04, 0x84, 0x80, 0xF0, 0x89, 0x80, 0x84,
+	0x30, 0xC8, 0x80, 0x80, 0x80, 0x80, 0xF0, 0x08, 0x84, 0x84, 0x80, 0xF0,
+	0x09, 0x08, 0x83, 0x03, 0xD0, 0x80, 0x80, 0x80, 0x08, 0xF8, 0x48, 0x80,
+	0x84, 0x80, 0xF8, 0x88, 0x80, 0x03, 0x03, 0xD8, 0x80, 0xD0, 0x03, 0x08,
+	0xD8, 0x30, 0x80, 0x85, 0x80, 0xBC, 0x08, 0x08, 0x25, 0x82, 0xE0, 0x08,
+	0xC0, 0x83, 0x80, 0xE0, 0x03, 0x08, 0x84, 0x80, 0xCC, 0x08, 0x08, 0x35,
+	0x08, 0xC8, 0x08, 0x8C, 0x84, 0x80, 0xD0, 0x03, 0x08, 0x85, 0xC0, 0xB8,
+	0x08, 0x08, 0x36, 0x08, 0xC8, 0x08, 0x0D, 0x03, 0x88, 0xD0, 0x03, 0x08,
+	0x05, 0xC8, 0xC8, 0x80, 0x80, 0x17, 0x80, 0xC0, 0x80, 0x0B, 0x84, 0x80,
+	0x80, 0x80, 0x80, 0x07, 0xB9, 0xD0, 0x08, 0x80, 0x17, 0x80, 0xC0, 0xB0,
+	0x08, 0x84, 0x80, 0x80, 0x00, 0x88, 0x07, 0x0C, 0xB8, 0x08, 0x48, 0x86,
+	0x80, 0xC0, 0xB0, 0x08, 0x84, 0x00, 0xC4, 0x80, 0x80, 0x85, 0x0B, 0xD8,
+	0x80, 0x40, 0x03, 0x08, 0xD8, 0x0C, 0x08, 0x84, 0x80, 0xB5, 0x08, 0x08,
+	0xB5, 0x08, 0xD8, 0x80, 0x40, 0x03, 0x80, 0xD8, 0x0C, 0x08, 0x84, 0x40,
+	0xB8, 0x08, 0x08, 0xB6, 0x08, 0xD8, 0x80, 0x84, 0x04, 0x88, 0xC0, 0x0C,
+	0x08, 0x84, 0x30, 0xD0, 0x80, 0x80, 0x80, 0x80, 0xF0, 0x08, 0x04, 0x83,
+	0x80, 0xF0, 0x8A, 0x10, 0x82, 0x50, 0xB8, 0x08, 0x08, 0x08, 0x08, 0xFB,
+	0x40, 0x00, 0x85, 0x80, 0xFA, 0x08, 0x08, 0x03, 0x03, 0x8C, 0x08, 0x08,
+	0x08, 0x08, 0xF8, 0x59, 0x10, 0x02, 0x88, 0xAF, 0x08, 0x48, 0x80, 0x85,
+	0x99, 0x08, 0x08, 0x88, 0x00, 0xAD, 0x14, 0x10, 0x04, 0x08, 0xBF, 0x08,
+	0x28, 0x63, 0x08, 0x8C, 0x00, 0x98, 0x01, 0x08, 0x8F, 0x84, 0x30, 0x80,
+	0xD0, 0x0C, 0x08, 0x48, 0x40, 0x08, 0x9B, 0x80, 0x3E, 0x80, 0x80, 0x8C,
+	0x04, 0x58, 0x08, 0xC8, 0x0B, 0x08, 0x68, 0x20, 0x80, 0x0C, 0x08, 0x3D,
+	0x08, 0x08, 0x3D, 0x80, 0x50, 0x08, 0xC8, 0x0C, 0x08, 0x58, 0x83, 0x80,
+	0x8C, 0xA0, 0x5A, 0x08, 0x80, 0x3D, 0x80, 0x50, 0x08, 0x8C, 0x8B, 0x80,
+	0x60, 0x03, 0x08, 0x8D, 0xC0, 0x48, 0x08, 0x08, 0x08, 0x80, 0x70, 0x08,
+	0x0C, 0x0C, 0x08, 0x78, 0x00, 0x08, 0x0B, 0xA9, 0x58, 0x08, 0x08, 0x08,
+	0x08, 0x78, 0xC0, 0x80, 0x8B, 0x80, 0x70, 0x82, 0x80, 0x8B, 0x0D, 0x48,
+	0x80, 0x08, 0x08, 0x80, 0x70, 0xC0, 0x08, 0x0C, 0x08, 0x34, 0x08, 0x08,
+	0x8D, 0x0C, 0x48, 0x80, 0x40, 0x0C, 0x08, 0x58, 0xB8, 0x80, 0x0C, 0x08,
+	0x44, 0x08, 0x08, 0xBD, 0x80, 0x40, 0x80, 0x50, 0x8B, 0x80, 0x68, 0x0B,
+	0x08, 0x0D, 0x18, 0x52, 0x08, 0x08, 0xCC, 0x80, 0x30, 0x80, 0x05, 0x0C,
+	0x08, 0x58, 0x8B, 0x80, 0x0C, 0x48, 0x40, 0x08, 0x08, 0x9F, 0x08, 0x20,
+	0x00, 0x84, 0x0C, 0x08, 0x08, 0x08, 0x80, 0x8F, 0x40, 0x48, 0x08, 0x08,
+	0x9F, 0x00, 0x38, 0x38, 0x00, 0x0D, 0x88, 0x80, 0x00, 0x08, 0x8F, 0x84,
+	0x30, 0x80, 0x80, 0xAF, 0x80, 0x30, 0x50, 0x08, 0x8C, 0x80, 0x4C, 0x08,
+	0x08, 0x8C, 0x84, 0x40, 0x08, 0xC8, 0x8B, 0x80, 0x50, 0x40, 0x08, 0x8C,
+	0x80, 0x4C, 0x08, 0x08, 0x1D, 0x82, 0x40, 0x08, 0xC8, 0x0C, 0x08, 0x58,
+	0x83, 0x80, 0x8C, 0x80, 0x3D, 0x80, 0x80, 0x4D, 0x08, 0x48, 0x08, 0xAA,
+	0x8C, 0x80, 0x60, 0x83, 0x80, 0x8C, 0xD0, 0x30, 0x08, 0x08, 0x3D, 0x80,
+	0x50, 0x80, 0x8C, 0x0C, 0x08, 0x78, 0x01, 0x88, 0x8A, 0xC8, 0x40, 0x08,
+	0x98, 0x01, 0x08, 0x78, 0x90, 0x0B, 0x0D, 0x08, 0x78, 0x81, 0x00, 0x0C,
+	0x0B, 0x30, 0x08, 0x08, 0x08, 0x08, 0x44, 0xF8, 0x80, 0x0C, 0x08, 0x63,
+	0x08, 0x98, 0x0A, 0x8C, 0x40, 0x08, 0x28, 0x0A, 0x08, 0x71, 0xC8, 0xB0,
+	0x09, 0x08, 0x27, 0x80, 0xC0, 0x08, 0x8C, 0x22, 0x08, 0x58, 0x8B, 0x80,
+	0x05, 0x0C, 0x98, 0x8B, 0x00, 0x37, 0x08, 0xA8, 0xEA, 0x80, 0x84, 0x80,
+	0x81, 0x88, 0x80, 0x53, 0x0E, 0xB8, 0x08, 0x68, 0x11, 0x80, 0xD0, 0xB8,
+	0x80, 0x04, 0x80, 0xB5, 0x08, 0x08, 0xA5, 0x89, 0xE0, 0x80, 0x40, 0x83,
+	0x80, 0xD0, 0x0C, 0x08, 0x84, 0x80, 0xB4, 0x08, 0x08, 0xB6, 0x08, 0xC8,
+	0x08, 0x04, 0x84, 0x80, 0xD0, 0x8B, 0x80, 0x05, 0x48, 0xB8, 0x80, 0x08,
+	0xB6, 0x08, 0xC8, 0x08, 0x04, 0x84, 0x80, 0xF0, 0x89, 0x80, 0x84, 0x30,
+	0xC8, 0x80, 0x80, 0x80, 0x80, 0xF0, 0x08, 0x84, 0x04, 0x08, 0xF8, 0x09,
+	0x08, 0x83, 0x22, 0xD8, 0x08, 0x80, 0x80, 0x08, 0xF0, 0x48, 0x08 };
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-background battery sampling.  The ADC scans the battery      *
+ *				 channel 16 times per burst on its own, then one interrupt    *
+ *				 averages the buffer into battLevel.                          *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "config.h"
+#include "battery.h"
+#include "sched.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		BATT_BURST			16			// conversions per interrupt (SMPI + 1)
+#define		bnADON				15
+#define		bnASAM				2
+
+/* ------------------------------------------------------------ */
+/*				Global Variables								*/
+/* ------------------------------------------------------------ */
+volatile HWORD	battLevel = 0;
+volatile BOOL	fBattReady = fFalse;
+volatile WORD	battBursts = 0;
+volatile HWORD	battLoad = 0;
+
+static WORD		battAcc = 0;		// IIR state, 12-bit counts << 2
+static WORD		battTick = 0;
+static WORD		battLedMs = 0;		// lit-LED milliseconds in this burst
+static WORD		battBurstMs = 0;	// length of this burst in ms
+
+// number of lit LEDs for each 4-bit LED state
+static const BYTE rgcLeds[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Service Routines						*/
+/* ------------------------------------------------------------ */
+
+//end of burst: ADC1BUF0-F hold 16 conversions of the battery channel
+void __ISR(_ADC_VECTOR, ipl1) ADCHandler(void)
+{
+	volatile unsigned int *pbuf = &ADC1BUF0;
+	WORD	sum = 0;
+	WORD	i;
+
+	// the buffers are 16 bytes apart
+	for (i = 0; i < BATT_BURST; i++)
+		sum += pbuf[i * 4];
+
+	// CLRASAM already stopped sampling; power down until the next burst
+	AD1CON1CLR = ( 1 << bnADON );
+	mAD1ClearIntFlag();
+
+	// sum of 16 10-bit samples = 14 bits; keep 12 bits plus 2 fraction bits
+	if (!fBattReady)
+		battAcc = sum;
+	else
+		battAcc += ( (int)sum - (int)battAcc ) >> BATT_IIR_SHIFT;
+
+	battLevel = battAcc >> 2;
+	battLoad = battBurstMs ? ( battLedMs << 8 ) / battBurstMs : 0;
+	battBurstMs = 0;
+	battLedMs = 0;
+	battBursts++;
+	fBattReady = fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+static void BattStart(void)
+{
+	AD1CON1SET = ( 1 << bnADON );
+	AD1CON1SET = ( 1 << bnASAM );	// auto-sample, auto-convert until SMPI
+}
+
+//battery channel scanned into all 16 buffers, one interrupt per burst
+void BattInit(void)
+{
+	AD1CON1 = 0;
+	AD1PCFG = ~( 1 << BATT_CH );	// only the battery pin is analog
+	AD1CSSL = ( 1 << BATT_CH );		// scan list: battery channel only
+	AD1CON1 = 0x00F0;				// internal counter ends sampling, CLRASAM
+	AD1CON2 = 0x043C;				// scan inputs, interrupt every 16th conversion
+	AD1CON3 = 0x1F3F;				// Tsamp = 32 x Tad
+
+	// ADC interrupt priority level 1
+	IPC6CLR = ( 7 << 26 ) | ( 3 << 24 );
+	IPC6SET = ( 1 << 26 );
+	IFS1CLR = ( 1 << 1 );
+	IEC1SET = ( 1 << 1 );
+
+	battTick = 0;
+	BattStart();
+}
+
+void BattTick(void)
+{
+	// LEDs sag the supply; note how many are lit while sampling
+	if (AD1CON1 & ( 1 << bnASAM )) {
+		battLedMs += rgcLeds[( prtLed1 >> bnLed1 ) & 0xF];
+		battBurstMs++;
+	}
+
+	// a due burst waits for the gap after a beat
+	if (++battTick >= BATT_INTERVAL && SchedIoWindow()) {
+		battTick = 0;
+		BattStart();
+	}
+}
@@ -0,0 +1,57 @@
+/************************************************************************/
+/*																		*/
+/*	battery.h -- Background battery voltage sampling					*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	The ADC runs in auto-sample scan mode on the battery channel and	*/
+/*	fills ADC1BUF0-F without CPU help.  The ADC interrupt sums the		*/
+/*	16 results (oversampling by 16, decimated to 12 bits) and folds		*/
+/*	them into a smoothed level.  Bursts are restarted at a low rate		*/
+/*	from the 1 ms tick, and the ADC is off in between.  Reading the		*/
+/*	battery is a single variable access.								*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_BATTERY_INC)
+#define _BATTERY_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	BATT_CH				8		// battery divider on AN8
+#define	BATT_INTERVAL		250		// ms between sample bursts
+#define	BATT_IIR_SHIFT		2		// smoothing: 1/4 of each new burst
+
+/* ------------------------------------------------------------ */
+/*					Variable Declarations						*/
+/* ------------------------------------------------------------ */
+
+// smoothed battery reading, 12-bit ADC counts (10-bit reading * 4)
+extern volatile HWORD	battLevel;
+extern volatile BOOL	fBattReady;
+// bursts completed so far; consumers compare it to see fresh data
+extern volatile WORD	battBursts;
+// average number of lit LEDs during the last burst, * 256
+extern volatile HWORD	battLoad;
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	BattInit(void);
+//call once per millisecond; restarts a burst every BATT_INTERVAL
+// and tracks LED load while a burst is sampling
+void	BattTick(void);
+
+#define	BattGetLevel()		(battLevel)
+#define	BattGetAdc()		(battLevel >> 2)		// 10-bit counts
+#define	BattReady()			(fBattReady)
+
+/* ------------------------------------------------------------ */
+
+#endif
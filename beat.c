@@ -0,0 +1,451 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-beat engine.  Timer2 marks the pulses, a per-bar table says  *
+ *				 what happens on each, and OC1 produces the blip in single-   *
+ *				 pulse mode, so neither the spacing nor the blip width depend *
+ *				 on the main loop.                                            *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "config.h"
+#include "stdtypes.h"
+#include "power.h"
+#include "audio.h"
+#include "midi.h"
+#include "beat.h"
+#include "meter.h"
+#include "poly.h"
+#include "groove.h"
+#include "ramp.h"
+#include "sched.h"
+#include "led.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		bnON				15
+#define		bnTCKPS				4
+#define		OCM_SINGLE			4			// dual compare, single output pulse
+#define		OCM_MASK			7
+#define		PULSE_START			1			// OC1R: rising edge one tick into the beat
+#define		SEG_MAX				65536		// longest Timer2 period
+
+/* ------------------------------------------------------------ */
+/*				Global Variables								*/
+/* ------------------------------------------------------------ */
+volatile WORD	beatCount = 0;
+volatile WORD	beatPulse = 0;
+volatile WORD	barCount = 0;
+volatile WORD	barPulse = 0;
+
+static const struct bar * volatile	pbarCur = NULL;
+static const struct bar * volatile	pbarNext = NULL;	// taken at the next bar line
+
+static volatile WORD	beatPeriod = 0;		// ticks in the beat now running
+static volatile WORD	beatPeriodNext = 0;	// applied at the next beat, 0 = none
+static volatile int		beatShift = 0;		// one-off length change of the next beat
+static WORD		beatLen = 0;		// ticks in this beat, period plus shift
+static volatile WORD	tckSeg = 0;		// time of this segment's start
+static volatile WORD	tckBeat = 0;	// time of the last beat
+static volatile WORD	beatWidth = BeatUsToTicks(5000);
+static WORD		segRemain = 0;		// ticks left in this pulse after this segment
+static BOOL		fArmPending = fFalse;	// blip done, re-arm before the next event
+static volatile BOOL	fBeatRun = fFalse;	// between BeatStart() and BeatStop()
+static volatile BOOL	fEvents = fTrue;	// bar table drives LEDs and sound
+static int		rgdtckPulse[BEAT_PPQN];	// groove corrections, see groove.h
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+//Pulses share out the beat period so that they always add up to it
+// exactly; none differs from period / BEAT_PPQN by a tick or more.
+static WORD PulseLength(WORD period, WORD pulse)
+{
+	return ( ( period * ( pulse + 1 ) ) / BEAT_PPQN ) - ( ( period * pulse ) / BEAT_PPQN );
+}
+
+//event on the coming pulse, or NULL.  Nothing sounds in the lead-in
+// beat before the first beat.
+static const struct ev * NextEvent(void)
+{
+	const struct bar *pbar = pbarCur;
+	WORD	ipulse = barPulse + 1;
+
+	if (!fEvents)
+		return NULL;
+	if (ipulse == pbar->cpulse) {
+		ipulse = 0;
+		if (pbarNext != NULL)
+			pbar = pbarNext;
+	}
+	else if (beatCount == 0 && beatPulse != BEAT_PPQN - 1)
+		return NULL;
+
+	return ( pbar->rgev[ipulse].msk != 0 ) ? &pbar->rgev[ipulse] : NULL;
+}
+
+//the next OC1R match starts a pulse with an event
+static BOOL FLastSegment(void)
+{
+	return segRemain == 0 && NextEvent() != NULL;
+}
+
+//length of the next Timer2 segment.  Pulses longer than 16 bits are
+// split so that no segment is shorter than SEG_MAX / 2; the ISR has
+// to get in before a segment ends.
+static WORD SegLength(WORD remain)
+{
+	if (remain > 2 * SEG_MAX)
+		return SEG_MAX;
+	if (remain > SEG_MAX)
+		return remain / 2;
+	return remain;
+}
+
+//OC1RS for the next blip, its event's share of the base width.  The
+// falling edge has to land inside the first segment of the pulse or it
+// never will, so the width is clamped to the first segment of a pulse
+// of the shorter of the current and pending period.
+static WORD BlipEnd(const struct ev *pev)
+{
+	WORD	width = ( beatWidth * pev->wscale ) / 4;
+	WORD	periodMin = beatPeriod;
+	WORD	pulseMin;
+	WORD	segFirst;
+
+	if (beatPeriodNext != 0 && beatPeriodNext < periodMin)
+		periodMin = beatPeriodNext;
+	if (beatShift < 0)
+		periodMin -= -beatShift;
+	pulseMin = PulseLength(periodMin, 0);
+	// a groove can take half a straight pulse off a shifted one
+	if (GrooveActive())
+		pulseMin /= 3;
+	segFirst = SegLength(pulseMin);
+	if (width > segFirst - PULSE_START - 2)
+		width = segFirst - PULSE_START - 2;
+
+	return PULSE_START + width;
+}
+
+//single pulse mode fires on the next OC1R match, i.e. one tick into
+// the next segment.  Only called during the last segment before an event.
+static void ArmPulse(void)
+{
+	OC1RS = BlipEnd(NextEvent());
+	OC1CONCLR = OCM_MASK;
+	OC1CONSET = OCM_SINGLE;
+	fArmPending = fFalse;
+}
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Service Routines						*/
+/* ------------------------------------------------------------ */
+
+//segment boundary.  When no ticks are left this is a MIDI clock
+// pulse, at pulse 0 a beat, and whatever the bar table holds for it
+// happens now, with OC1 already raising the blip.  The clock byte goes
+// out first so its latency doesn't depend on the rest of the handler.
+void __ISR(_TIMER_2_VECTOR, ipl6) BeatHandler(void)
+{
+	const struct ev *pev;
+	WORD	len;
+	BOOL	fResolve;
+
+	mT2ClearIntFlag();
+
+	// PR2 still holds the segment that just ended
+	tckSeg += PR2 + 1;
+
+	// stopped: Timer2 only keeps the time base going
+	if (!fBeatRun) {
+		PR2 = SEG_MAX - 1;
+		return;
+	}
+
+	if (segRemain == 0) {
+		if (++beatPulse == BEAT_PPQN)
+			beatPulse = 0;
+		MidiPulse(beatPulse == 0);
+
+		if (++barPulse == pbarCur->cpulse) {
+			barPulse = 0;
+			if (pbarNext != NULL) {
+				pbarCur = pbarNext;
+				pbarNext = NULL;
+			}
+			barCount++;
+		}
+
+		if (beatPulse == 0) {
+			// a practice ramp moves the tempo on at bar lines, from
+			// the first downbeat on
+			fResolve = ( barPulse == 0 );
+			if (fResolve && beatCount != 0)
+				RampBar();
+
+			// a new period set by the main loop starts with this beat
+			if (beatPeriodNext != 0) {
+				beatPeriod = beatPeriodNext;
+				beatPeriodNext = 0;
+				fResolve = fTrue;
+			}
+			// the groove is worked out per bar, not per pulse
+			if (fResolve)
+				GrooveResolve(beatPeriod, rgdtckPulse);
+			beatLen = beatPeriod + beatShift;
+			beatShift = 0;
+			tckBeat = tckSeg;
+			beatCount++;
+		}
+		segRemain = PulseLength(beatLen, beatPulse) + rgdtckPulse[beatPulse];
+
+		// polyrhythm voices restart from each bar line, and may take
+		// over from the table right here
+		if (barPulse == 0)
+			PolyBar(tckSeg, beatLen + ( pbarCur->cbeat - 1 ) * beatPeriod, beatWidth);
+
+		// lights only go on if OC1 was armed to turn them off again
+		pev = &pbarCur->rgev[barPulse];
+		if (pev->msk != 0 && beatCount != 0 && fEvents) {
+			if (!fArmPending)
+				latLedSet = pev->msk;
+			AudioPlay(pev->wave);
+			// this segment starts on the event's tick
+			SchedClickOnset(BeatNow() - tckSeg);
+		}
+	}
+
+	// TMR2 is only a few ticks into the segment, so the PR2 write for
+	// this segment can't be missed
+	len = SegLength(segRemain);
+	PR2 = len - 1;
+	segRemain -= len;
+
+	PolySegment(tckSeg, len);
+
+	if (fArmPending && FLastSegment())
+		ArmPulse();
+}
+
+//falling edge of the blip: LEDs off and arm the pulse for the next
+// event, or leave that to the segment handler if more segments come first
+void __ISR(_OUTPUT_COMPARE_1_VECTOR, ipl6) BlipEndHandler(void)
+{
+	mOC1ClearIntFlag();
+
+	latLedClr = LED_ALL;
+
+	if (FLastSegment())
+		ArmPulse();
+	else
+		fArmPending = fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+//Timer2 runs from here on, stopped or not, so BeatNow() always works
+void BeatInit(void)
+{
+	T2CON = 0;
+	OC1CON = 0;
+	fBeatRun = fFalse;
+
+	// Timer2 interrupt, priority level 6
+	IPC2CLR = ( 7 << 2 ) | ( 3 << 0 );
+	IPC2SET = ( 6 << 2 );
+	IFS0CLR = ( 1 << 8 );
+	IEC0SET = ( 1 << 8 );
+
+	// OC1 interrupt, priority level 6
+	IPC1CLR = ( 7 << 18 ) | ( 3 << 16 );
+	IPC1SET = ( 6 << 18 );
+	IFS0CLR = ( 1 << 6 );
+
+	// OC1 pin as output, low
+	trisOC1Clr = ( 1 << bnOC1 );
+	prtOC1Clr = ( 1 << bnOC1 );
+
+	TMR2 = 0;
+	PR2 = SEG_MAX - 1;
+	T2CON = ( PowerGetBeatCkps() << bnTCKPS );
+	T2CONSET = ( 1 << bnON );
+}
+
+//MeterInit() has to have given the engine a bar first.
+// The time base carries on across the restart: the ticks already
+// counted in the idle segment go into tckSeg before TMR2 is moved.
+void BeatStart(WORD period)
+{
+	BeatStartIn(period, period, 0);
+}
+
+//A lead-in shorter than the period brings the first beat in sooner,
+// e.g. at power-up, and the first beat need not be a downbeat.  The
+// lead-in has no groove; the first beat works that out.
+void BeatStartIn(WORD period, WORD tckLead, WORD beat)
+{
+	unsigned int intStat;
+	WORD	len;
+	WORD	pulse;
+
+	BeatStop();
+
+	intStat = INTDisableInterrupts();
+
+	beatPeriod = period;
+	beatPeriodNext = ( tckLead != period ) ? period : 0;
+	beatShift = 0;
+	beatLen = tckLead;
+	beatCount = 0;
+	beatPulse = 0;
+
+	// beat zero is a silent lead-in: the beat before the first one
+	if (pbarNext != NULL) {
+		pbarCur = pbarNext;
+		pbarNext = NULL;
+	}
+	barCount = 0;
+	if (beat >= pbarCur->cbeat)
+		beat = 0;
+	barPulse = ( ( beat + pbarCur->cbeat - 1 ) % pbarCur->cbeat ) * BEAT_PPQN;
+
+	// pulse 0 of beat zero starts now, so the first beat comes one
+	// lead-in from now
+	if (IFS0 & ( 1 << 8 )) {
+		tckSeg += PR2 + 1;
+		IFS0CLR = ( 1 << 8 );
+	}
+	tckSeg += TMR2 - ( PULSE_START + 1 );
+	tckBeat = tckSeg;
+	if (tckLead == period)
+		GrooveResolve(period, rgdtckPulse);
+	else
+		for (pulse = 0; pulse < BEAT_PPQN; pulse++)
+			rgdtckPulse[pulse] = 0;
+	segRemain = PulseLength(tckLead, 0) + rgdtckPulse[0];
+	len = SegLength(segRemain);
+	PR2 = len - 1;
+	segRemain -= len;
+
+	// start past OC1R so the first pulse comes with the first beat
+	TMR2 = PULSE_START + 1;
+	OC1R = PULSE_START;
+	OC1CON = 0;
+	OC1CONSET = ( 1 << bnON );
+	if (FLastSegment())
+		ArmPulse();
+	else
+		fArmPending = fTrue;
+
+	IFS0CLR = ( 1 << 6 );
+	IEC0SET = ( 1 << 6 );
+	fBeatRun = fTrue;
+
+	INTRestoreInterrupts(intStat);
+}
+
+void BeatStop(void)
+{
+	fBeatRun = fFalse;
+	PolyHalt();
+	OC1CONCLR = ( 1 << bnON );
+	IEC0CLR = ( 1 << 6 );
+	latLedClr = LED_ALL;
+}
+
+void BeatSetPeriod(WORD period)
+{
+	beatPeriodNext = period;
+}
+
+WORD BeatGetPeriod(void)
+{
+	return beatPeriod;
+}
+
+BOOL BeatRunning(void)
+{
+	return fBeatRun;
+}
+
+//every pulse ends a segment, so this also covers MIDI clock and
+// bar table events
+WORD BeatTicksToNext(void)
+{
+	unsigned int intStat;
+	WORD	tck;
+
+	intStat = INTDisableInterrupts();
+	tck = ( IFS0 & ( 1 << 8 ) ) ? 0 : PR2 - TMR2;
+	INTRestoreInterrupts(intStat);
+
+	return tck;
+}
+
+//off while the polyrhythm voices own the LEDs and sound
+void BeatSetEvents(BOOL fOn)
+{
+	fEvents = fOn;
+}
+
+//NULL withdraws a table that hasn't been taken yet
+void BeatSetBar(const struct bar *pbar)
+{
+	pbarNext = pbar;
+}
+
+const struct bar * BeatGetBar(void)
+{
+	return pbarCur;
+}
+
+WORD BeatGetPeriodNext(void)
+{
+	WORD	period = beatPeriodNext;
+
+	return ( period != 0 ) ? period : beatPeriod;
+}
+
+//Spreads the shift over all pulses of the next beat, so the MIDI
+// clock bends rather than jumps.  Calls before that beat add up.
+void BeatShift(int ticks)
+{
+	unsigned int intStat;
+
+	// a beat is never cut by more than a quarter
+	intStat = INTDisableInterrupts();
+	beatShift += ticks;
+	if (beatShift < -(int)( beatPeriod / 4 ))
+		beatShift = -(int)( beatPeriod / 4 );
+	INTRestoreInterrupts(intStat);
+}
+
+//Time zero is when BeatInit() started Timer2.  A rollover
+// the ISR hasn't handled yet shows up as the pending T2 flag.
+WORD BeatNow(void)
+{
+	unsigned int intStat;
+	WORD	tck;
+
+	intStat = INTDisableInterrupts();
+	tck = tckSeg + TMR2;
+	if (IFS0 & ( 1 << 8 ))
+		tck = tckSeg + PR2 + 1 + TMR2;
+	INTRestoreInterrupts(intStat);
+
+	return tck;
+}
+
+WORD BeatLastBeat(void)
+{
+	return tckBeat;
+}
+
+void BeatSetWidthUs(WORD us)
+{
+	beatWidth = BeatUsToTicks(us);
+}
@@ -0,0 +1,92 @@
+/************************************************************************/
+/*																		*/
+/*	beat.h -- Hardware-timed beat engine								*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Timer2 runs at a fixed 2.5 MHz tick whatever the power level.		*/
+/*	A beat is BEAT_PPQN pulses, the MIDI clock grid, and each pulse is	*/
+/*	one or more Timer2 periods ("segments").  Pulses add up to the		*/
+/*	beat period exactly, so beats longer than 16 bits need no 32-bit	*/
+/*	timer and Timer3 stays free for the audio PWM.  Output				*/
+/*	compare 1 runs in single-pulse mode on Timer2, so the blip on OC1	*/
+/*	(RD0) starts one tick after the beat and its width is exact to		*/
+/*	the tick.  What happens on each pulse (LEDs, sound, blip width)		*/
+/*	comes from a per-bar table built by meter.c, so the Timer2			*/
+/*	interrupt does one lookup per pulse.  It lights the LEDs and the	*/
+/*	OC1 falling-edge interrupt turns them off.  The main loop never		*/
+/*	waits on a beat.													*/
+/*																		*/
+/*	Pulses are even unless a groove (groove.h) is set; then each one	*/
+/*	is stretched or squeezed by a correction looked up per pulse.		*/
+/*																		*/
+/*	Timer2 keeps running while the beat is stopped, so BeatNow() is		*/
+/*	one continuous time base for timestamping MIDI clock and taps.		*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_BEAT_INC)
+#define _BEAT_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	BEAT_TICK_HZ		2500000L
+#define	BEAT_PPQN			24			// pulses per beat (quarter note)
+#define	BEAT_TICKS_PER_T1	2560		// one 1.024 ms Timer1 tick
+#define	BeatUsToTicks(us)	( ( (us) * 5 ) / 2 )
+#define	BEAT_TICKS_PER_MIN	( 60 * BEAT_TICK_HZ )
+#define	BeatBpmToPeriod(bpm)	( BEAT_TICKS_PER_MIN / (bpm) )
+#define	BeatPeriodToBpm(p)	( ( BEAT_TICKS_PER_MIN + (p) / 2 ) / (p) )
+
+struct bar;							// meter.h
+
+/* ------------------------------------------------------------ */
+/*					Variable Declarations						*/
+/* ------------------------------------------------------------ */
+
+extern volatile WORD	beatCount;		// beats since BeatStart()
+extern volatile WORD	beatPulse;		// pulse within the beat, 0 = on the beat
+extern volatile WORD	barCount;		// bar lines since BeatStart()
+extern volatile WORD	barPulse;		// pulse within the bar
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	BeatInit(void);
+//first beat comes one period after the call
+void	BeatStart(WORD period);
+//same, but tckLead after the call and on beat (from 0) of the bar
+void	BeatStartIn(WORD period, WORD tckLead, WORD beat);
+void	BeatStop(void);
+BOOL	BeatRunning(void);
+//new period (in beat ticks) takes effect at the next beat boundary
+void	BeatSetPeriod(WORD period);
+WORD	BeatGetPeriod(void);
+//the period the next beat will have, pending change included
+WORD	BeatGetPeriodNext(void);
+//per-pulse event table (meter.h), switched to at the next bar line
+void	BeatSetBar(const struct bar *pbar);
+const struct bar *	BeatGetBar(void);
+//bar table events on or off (poly.c takes over the LEDs)
+void	BeatSetEvents(BOOL fOn);
+//base blip width in microseconds, scaled per event; clamped to fit
+// inside one pulse
+void	BeatSetWidthUs(WORD us);
+//move the beat phase by ticks (+ later) over the next beat
+void	BeatShift(int ticks);
+//beat ticks since BeatInit(), wrapping at 32 bits; compare by difference
+WORD	BeatNow(void);
+//BeatNow() time of the most recent beat
+WORD	BeatLastBeat(void);
+//beat ticks until the Timer2 interrupt for the next pulse or segment
+WORD	BeatTicksToNext(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -64,6 +64,12 @@
 #define	prtLed4Inv			PORTBINV
 #define	bnLed4				13
 
+/*	All four LEDs are on PORTB, so a mask of them (led.h) changes
+	together in one write to the latch.
+*/
+#define	latLedSet			LATBSET
+#define	latLedClr			LATBCLR
+
 /*	Onboard Buttons
 */
 
@@ -85,6 +91,8 @@
 
 
 /*JE 1-4 pins (PmodBTN)
+	JE3/JE4 are also UART1 RX/TX, the MIDI port: the buttons are only
+	read in a build with PMOD_BTN, which leaves MIDI off.
 */
 
 #define	trisJE1			TRISD
@@ -120,7 +128,11 @@
 #define	bnJE4			8
 
 /*JA 1-4 pins (PmodSWT)
+	RE0-RE3, so one read gives the 4-bit code.  They are also PMD0-3
+	of the LCD bus: read in a build with PMOD_SWT, with the PMP idle.
 */
+#define	prtSwt			PORTE
+#define	bnSwt			0
 #define	trisJA1			TRISE
 #define	trisJA1Set		TRISESET
 #define	trisJA1Clr		TRISECLR
@@ -154,6 +166,19 @@
 #define	swtJA4			3
 
 
+/*	Output compare 1 (beat pulse)
+*/
+#define	trisOC1Clr			TRISDCLR
+#define	prtOC1Clr			PORTDCLR
+#define	bnOC1				0
+
+/*	Output compare 4 (audio PWM)
+*/
+#define	trisOC4Set			TRISDSET
+#define	trisOC4Clr			TRISDCLR
+#define	prtOC4Clr			PORTDCLR
+#define	bnOC4				3
+
 /*	Left motor
 */
 #define	trisMtrLeftEnSet	TRISDSET
@@ -0,0 +1,199 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-button gestures, recognized in the main loop from edges      *
+ *				 queued by the debounce interrupt.                            *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "beat.h"
+#include "gesture.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		cedgeQueue			8
+#define		cevQueue			4
+#define		stIdle				0
+#define		stDown				1			// press under way
+#define		stWait				2			// released; a double tap may follow
+#define		stDone				3			// acted on, waiting for all released
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct edge {
+	WORD	tck;
+	WORD	btn;			// buttons down after the edge
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static volatile struct edge	rgedge[cedgeQueue];
+static volatile WORD	iedgeIn = 0;		// debounce ISR only
+static volatile WORD	iedgeOut = 0;		// main loop only
+
+static WORD		rgev[cevQueue];
+static WORD		rgtckEv[cevQueue];		// first press of each
+static WORD		tckEvLast = 0;
+static WORD		ievIn = 0;
+static WORD		ievOut = 0;
+
+static WORD		tckLong;
+static WORD		tckDouble;
+static WORD		tckChord;
+static WORD		btnDouble = 0;
+
+static WORD		st = stIdle;
+static WORD		btnGest = 0;		// buttons in this gesture
+static WORD		tckStart = 0;		// its press, or in stWait its release
+static WORD		tckPress = 0;		// its first press
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static void Emit(WORD kind, WORD btn)
+{
+	if (ievIn - ievOut < cevQueue) {
+		rgtckEv[ievIn % cevQueue] = tckPress;
+		rgev[ievIn++ % cevQueue] = kind | ( btn << 4 );
+	}
+}
+
+static void Press(WORD btn, WORD tck)
+{
+	st = stDown;
+	btnGest = btn;
+	tckStart = tck;
+	tckPress = tck;
+}
+
+//windows that have run out by time tck
+static void Expire(WORD tck)
+{
+	if (st == stDown && tck - tckStart >= tckLong) {
+		Emit(GEST_LONG, btnGest);
+		st = stDone;
+	}
+	else if (st == stWait && tck - tckStart >= tckDouble) {
+		Emit(GEST_SHORT, btnGest);
+		st = stIdle;
+	}
+}
+
+static void Step(WORD btn, WORD tck)
+{
+	switch (st) {
+		case stIdle:
+			if (btn != 0)
+				Press(btn, tck);
+			break;
+
+		case stDown:
+			if (btn & ~btnGest) {
+				// another button: a chord if it came soon enough
+				if (tck - tckStart < tckChord)
+					btnGest |= btn;
+				else
+					st = stDone;
+			}
+			else if (btn == 0) {
+				// a chord, or a button without double taps, is done now
+				if (( btnGest & ( btnGest - 1 ) ) != 0 || ( btnGest & btnDouble ) == 0) {
+					Emit(GEST_SHORT, btnGest);
+					st = stIdle;
+				}
+				else {
+					st = stWait;
+					tckStart = tck;
+				}
+			}
+			break;
+
+		case stWait:
+			if (btn == btnGest) {
+				Emit(GEST_DOUBLE, btnGest);
+				st = stDone;
+			}
+			else if (btn != 0) {
+				Emit(GEST_SHORT, btnGest);
+				Press(btn, tck);
+			}
+			break;
+
+		case stDone:
+			if (btn == 0)
+				st = stIdle;
+			break;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void GestureInit(void)
+{
+	GestureSetTimes(GEST_LONG_MS, GEST_DOUBLE_MS, GEST_CHORD_MS);
+	btnDouble = 0;
+	GestureClear();
+}
+
+void GestureSetTimes(WORD msLong, WORD msDouble, WORD msChord)
+{
+	tckLong = BeatUsToTicks(msLong * 1000);
+	tckDouble = BeatUsToTicks(msDouble * 1000);
+	tckChord = BeatUsToTicks(msChord * 1000);
+}
+
+void GestureSetDouble(WORD btn)
+{
+	btnDouble = btn;
+}
+
+void GestureClear(void)
+{
+	iedgeOut = iedgeIn;
+	ievOut = ievIn;
+	st = stIdle;
+}
+
+//a full queue drops the edge; the gesture then ends at the next one
+void GestureEdge(WORD btn, WORD tck)
+{
+	WORD	iedge = iedgeIn;
+
+	if (iedge - iedgeOut >= cedgeQueue)
+		return;
+	rgedge[iedge % cedgeQueue].tck = tck;
+	rgedge[iedge % cedgeQueue].btn = btn;
+	iedgeIn = iedge + 1;
+}
+
+WORD GestureNext(void)
+{
+	WORD	iedge;
+	WORD	tck;
+
+	// edges in the order they came, each after the windows it closed
+	while (iedgeOut != iedgeIn) {
+		iedge = iedgeOut % cedgeQueue;
+		tck = rgedge[iedge].tck;
+		Expire(tck);
+		Step(rgedge[iedge].btn, tck);
+		iedgeOut++;
+	}
+	Expire(BeatNow());
+
+	if (ievOut == ievIn)
+		return GEST_NONE;
+	tckEvLast = rgtckEv[ievOut % cevQueue];
+	return rgev[ievOut++ % cevQueue];
+}
+
+WORD GestureTime(void)
+{
+	return tckEvLast;
+}
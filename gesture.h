@@ -0,0 +1,66 @@
+/************************************************************************/
+/*																		*/
+/*	gesture.h -- Button gestures: short, long, double tap and chords	*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	The debounce interrupt hands every change of the debounced			*/
+/*	buttons to GestureEdge(), with the time the change really			*/
+/*	happened, and goes on.  The main loop takes gestures out with		*/
+/*	GestureNext(), which works through the edges queued since and		*/
+/*	through any window that has run out by now; nothing ever waits.		*/
+/*																		*/
+/*	A press held past the long window is GEST_LONG, fired while it is	*/
+/*	still held.  A second button within the chord window of the		*/
+/*	first makes a chord, GEST_SHORT or GEST_LONG with both buttons; a	*/
+/*	second button later than that cancels the gesture.  Anything else	*/
+/*	is GEST_SHORT on release, unless double taps are on for that		*/
+/*	button: then a second press inside the double window is				*/
+/*	GEST_DOUBLE, and the short press waits for the window to close.		*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_GESTURE_INC)
+#define _GESTURE_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	GEST_NONE			0
+#define	GEST_SHORT			1
+#define	GEST_LONG			2
+#define	GEST_DOUBLE			3
+
+#define	GEST_LONG_MS		500
+#define	GEST_DOUBLE_MS		250
+#define	GEST_CHORD_MS		100
+
+//an event is a kind and the buttons it used: bit 0 btn1, bit 1 btn2,
+// bits 2-5 the PmodBTN
+#define	GestKind(ev)		( (ev) & 0x0F )
+#define	GestButtons(ev)		( (ev) >> 4 )
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	GestureInit(void);
+void	GestureSetTimes(WORD msLong, WORD msDouble, WORD msChord);
+//buttons whose short presses wait to see if a double tap follows
+void	GestureSetDouble(WORD btn);
+//drops queued edges and any gesture under way
+void	GestureClear(void);
+//debounce ISR: buttons down from BeatNow() time tck on
+void	GestureEdge(WORD btn, WORD tck);
+//next gesture, or GEST_NONE
+WORD	GestureNext(void);
+//BeatNow() time of the first press of the gesture GestureNext() gave
+WORD	GestureTime(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,122 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-battery-aware governor.  Trades blip length, LCD refresh     *
+ *				 rate and clock speed for runtime as the battery drains.      *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include "stdtypes.h"
+#include "LCD.h"
+#include "power.h"
+#include "soc.h"
+#include "beat.h"
+#include "governor.h"
+#include "sched.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		GOV_HYST			5u			// % above a threshold needed to step back up
+#define		LED_UA				5000		// one lit LED
+#define		MAX_RUNTIME_MIN		( 999 * 60 + 59 )
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct govstage {
+	BYTE	pctEnter;		// enter this stage below this charge
+	BYTE	tmsBlip;		// LED on time per beat
+	BYTE	pwrLevel;
+	HWORD	tmsLcd;			// status field refresh interval
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static const struct govstage rggov[GOV_STAGES] = {
+	{ 101,	5,	PWR_RUN,	 2000 },	// GOV_NORMAL
+	{  30,	3,	PWR_LOW,	10000 },	// GOV_SAVE
+	{  10,	1,	PWR_LOW,	30000 },	// GOV_CRITICAL
+};
+
+// average core + LCD draw at each power level
+static const HWORD rguaLevel[PWR_LEVELS] = { 45000, 14000, 9000 };
+
+static WORD	govStage = GOV_NORMAL;
+static WORD	govLcdAt = 0;		// Timer1 count of the next status redraw
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void GovInit(void)
+{
+	govStage = GOV_NORMAL;
+	govLcdAt = 0;
+	BeatSetWidthUs(rggov[GOV_NORMAL].tmsBlip * 1000);
+}
+
+WORD GovGetStage(void)
+{
+	return govStage;
+}
+
+WORD GovGetBlipMs(void)
+{
+	return rggov[govStage].tmsBlip;
+}
+
+//remaining capacity over the average draw at this tempo
+WORD GovRuntimeMin(WORD tmsBeat)
+{
+	WORD	uaDraw;
+	WORD	min;
+
+	uaDraw = rguaLevel[rggov[govStage].pwrLevel];
+	if (tmsBeat != 0)
+		uaDraw += ( LED_UA * rggov[govStage].tmsBlip ) / tmsBeat;
+
+	min = ( SocGetRemainingMah() * 60000L ) / uaDraw;
+	return ( min > MAX_RUNTIME_MIN ) ? MAX_RUNTIME_MIN : min;
+}
+
+//pick the stage with hysteresis, apply it, and redraw the status field
+// when its interval is up.  It has the right half of the second row:
+// " 87%  12h" or, under ten hours, " 87% 9h05".
+void GovTask(WORD tmsNow, WORD tmsBeat)
+{
+	WORD	pct = SocGetPercent();
+	WORD	stage = govStage;
+	WORD	min;
+	char	sRun[12];
+	char	s[24];
+
+	if (!SocValid())
+		return;
+
+	while (stage < GOV_STAGES - 1 && pct < rggov[stage + 1].pctEnter)
+		stage++;
+	while (stage > GOV_NORMAL && pct >= rggov[stage].pctEnter + GOV_HYST)
+		stage--;
+
+	if (stage != govStage) {
+		govStage = stage;
+		PowerSetLevel(rggov[stage].pwrLevel);
+		BeatSetWidthUs(rggov[stage].tmsBlip * 1000);
+		govLcdAt = tmsNow;				// show the change right away
+	}
+
+	if ((int)( tmsNow - govLcdAt ) < 0 || !SchedIoWindow())
+		return;
+	govLcdAt = tmsNow + rggov[govStage].tmsLcd;
+
+	min = GovRuntimeMin(tmsBeat);
+	if (min < 10 * 60)
+		sprintf(sRun, "%dh%02d", (int)( min / 60 ), (int)( min % 60 ));
+	else
+		sprintf(sRun, "%3dh", (int)( min / 60 ));
+	sprintf(s, "%3d%% %s", (int)pct, sRun);
+	cmdLCD(0x80 | 0x47);
+	putsLCD(s);
+	idleLCD();
+}
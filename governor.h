@@ -0,0 +1,47 @@
+/************************************************************************/
+/*																		*/
+/*	governor.h -- Battery-aware performance governor					*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Watches the state of charge and steps the metronome down through	*/
+/*	NORMAL, SAVE and CRITICAL stages.  Each stage sets the LED blip		*/
+/*	length, how often the LCD status field is redrawn and the clock		*/
+/*	level.  Beat timing is unaffected since every power level keeps		*/
+/*	the timer tick length.  The status field, the right half of the		*/
+/*	second LCD row, shows the charge and the estimated remaining		*/
+/*	runtime at the current tempo.										*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_GOVERNOR_INC)
+#define _GOVERNOR_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	GOV_NORMAL			0
+#define	GOV_SAVE			1
+#define	GOV_CRITICAL		2
+#define	GOV_STAGES			3
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	GovInit(void);
+//tmsNow: Timer1 ms count, tmsBeat: beat period in the same ticks
+void	GovTask(WORD tmsNow, WORD tmsBeat);
+
+WORD	GovGetStage(void);
+WORD	GovGetBlipMs(void);
+//minutes left at this beat period
+WORD	GovRuntimeMin(WORD tmsBeat);
+
+/* ------------------------------------------------------------ */
+
+#endif
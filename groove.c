@@ -0,0 +1,179 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-swing and groove templates, resolved into per-pulse tick     *
+ *				 corrections for the beat engine.                             *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "beat.h"
+#include "groove.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		cpulseStep			( BEAT_PPQN / GROOVE_STEPS )
+#define		offStep				( GROOVE_UNIT / GROOVE_STEPS )
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static const char * const rgszGroove[GROOVE_COUNT] = {
+	"str", "sw8", "s16", "usr" };
+
+// one past the last step is the next beat, always 0
+static volatile int8_t	rgoffCur[GROOVE_STEPS + 1];
+static int8_t	rgoffUser[GROOVE_STEPS];
+static WORD		grooveCur = GROOVE_STRAIGHT;
+static WORD		swingPct = 58;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+//no sixteenth below half its straight length; that keeps every pulse
+// long enough for the blip (see BlipEnd() in beat.c)
+static BOOL FValid(const int8_t *rgoff)
+{
+	WORD	step;
+	int		offNext;
+
+	if (rgoff[0] != 0)
+		return fFalse;
+	for (step = 0; step < GROOVE_STEPS; step++) {
+		offNext = ( step + 1 < GROOVE_STEPS ) ? rgoff[step + 1] : 0;
+		if (offStep + offNext - rgoff[step] < offStep / 2)
+			return fFalse;
+	}
+	return fTrue;
+}
+
+//the ISR reads the offsets at bar lines, so they change in one go
+static void Apply(void)
+{
+	int8_t	rgoff[GROOVE_STEPS];
+	unsigned int intStat;
+	int		off;
+	WORD	step;
+
+	for (step = 0; step < GROOVE_STEPS; step++)
+		rgoff[step] = 0;
+
+	switch (grooveCur) {
+		case GROOVE_SWING8:
+			// the offbeat eighth moves, its sixteenths stay halfway
+			off = ( ( swingPct - 50 ) * GROOVE_UNIT ) / 100;
+			rgoff[1] = off / 2;
+			rgoff[2] = off;
+			rgoff[3] = off / 2;
+			break;
+		case GROOVE_SWING16:
+			off = ( ( swingPct - 50 ) * ( GROOVE_UNIT / 2 ) ) / 100;
+			rgoff[1] = off;
+			rgoff[3] = off;
+			break;
+		case GROOVE_USER:
+			for (step = 0; step < GROOVE_STEPS; step++)
+				rgoff[step] = rgoffUser[step];
+			break;
+	}
+
+	intStat = INTDisableInterrupts();
+	for (step = 0; step < GROOVE_STEPS; step++)
+		rgoffCur[step] = rgoff[step];
+	rgoffCur[GROOVE_STEPS] = 0;
+	INTRestoreInterrupts(intStat);
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void GrooveInit(void)
+{
+	WORD	step;
+
+	for (step = 0; step < GROOVE_STEPS; step++)
+		rgoffUser[step] = 0;
+	swingPct = 58;
+	GrooveSet(GROOVE_STRAIGHT);
+}
+
+void GrooveSet(WORD groove)
+{
+	grooveCur = ( groove < GROOVE_COUNT ) ? groove : GROOVE_STRAIGHT;
+	Apply();
+}
+
+WORD GrooveGet(void)
+{
+	return grooveCur;
+}
+
+void GrooveSetSwing(WORD pct)
+{
+	if (pct < GROOVE_SWING_MIN)
+		pct = GROOVE_SWING_MIN;
+	if (pct > GROOVE_SWING_MAX)
+		pct = GROOVE_SWING_MAX;
+	swingPct = pct;
+	Apply();
+}
+
+WORD GrooveGetSwing(void)
+{
+	return swingPct;
+}
+
+BOOL GrooveSetUser(const int8_t *rgoff)
+{
+	WORD	step;
+
+	if (!FValid(rgoff))
+		return fFalse;
+	for (step = 0; step < GROOVE_STEPS; step++)
+		rgoffUser[step] = rgoff[step];
+	if (grooveCur == GROOVE_USER)
+		Apply();
+	return fTrue;
+}
+
+BOOL GrooveActive(void)
+{
+	WORD	step;
+
+	for (step = 0; step < GROOVE_STEPS; step++)
+		if (rgoffCur[step] != 0)
+			return fTrue;
+	return fFalse;
+}
+
+const char * GrooveName(WORD groove)
+{
+	return ( groove < GROOVE_COUNT ) ? rgszGroove[groove] : "";
+}
+
+//Pulse p is moved by an offset interpolated between the sixteenths
+// either side of it, and its correction is how much further the next
+// pulse moves.  Pulses start and end the beat unmoved, so the
+// corrections add up to zero and the beat length stays exact.
+// period >> 4 keeps the product in range down to 20 BPM.
+void GrooveResolve(WORD period, int *rgdtck)
+{
+	int		p16 = (int)( period >> 4 );
+	int		dev = 0;
+	int		devNext;
+	WORD	pulse;
+	WORD	step;
+	WORD	j;
+
+	for (pulse = 0; pulse < BEAT_PPQN; pulse++) {
+		step = ( pulse + 1 ) / cpulseStep;
+		j = ( pulse + 1 ) % cpulseStep;
+		devNext = ( step < GROOVE_STEPS ) ?
+			( ( rgoffCur[step] * ( cpulseStep - j ) + rgoffCur[step + 1] * j ) * p16 ) /
+				( cpulseStep * GROOVE_UNIT / 16 ) : 0;
+		rgdtck[pulse] = devNext - dev;
+		dev = devNext;
+	}
+}
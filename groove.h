@@ -0,0 +1,67 @@
+/************************************************************************/
+/*																		*/
+/*	groove.h -- Swing and groove templates								*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	A groove moves the sixteenth positions of every beat off the		*/
+/*	straight grid.  A template is one signed offset per sixteenth, in	*/
+/*	256ths of a beat, so it holds at any tempo; the beat itself never	*/
+/*	moves, only the positions in between.  Swing is just a template:	*/
+/*	at 67% the offbeat eighth lands two thirds of the way through.		*/
+/*																		*/
+/*	The beat engine bends its pulse grid to follow the template.  At	*/
+/*	each bar line (and when the period changes) the template is			*/
+/*	resolved into a per-pulse table of tick corrections, and the		*/
+/*	pulse interrupt only adds the one for its pulse.  Everything on		*/
+/*	the pulse grid swings with it, MIDI clock included.					*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_GROOVE_INC)
+#define _GROOVE_INC
+
+#include "stdtypes.h"
+#include "beat.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	GROOVE_STRAIGHT		0
+#define	GROOVE_SWING8		1			// eighths, by GrooveSetSwing()
+#define	GROOVE_SWING16		2			// sixteenths, by GrooveSetSwing()
+#define	GROOVE_USER			3			// GrooveSetUser()
+#define	GROOVE_COUNT		4
+
+#define	GROOVE_STEPS		4			// sixteenths per beat
+#define	GROOVE_UNIT			256			// offsets are in 1/256 beat
+#define	GROOVE_SWING_MIN	50			// percent; straight
+#define	GROOVE_SWING_MAX	75			// dotted eighth and sixteenth
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+//straight, 58% swing ready for GROOVE_SWING8/16
+void	GrooveInit(void);
+//takes effect at the next bar line, or a tempo change if sooner
+void	GrooveSet(WORD groove);
+WORD	GrooveGet(void);
+//percent, clamped to GROOVE_SWING_MIN..MAX
+void	GrooveSetSwing(WORD pct);
+WORD	GrooveGetSwing(void);
+//GROOVE_STEPS offsets, the first must be 0.  fFalse (and no change)
+// if any sixteenth would shrink below half its straight length
+BOOL	GrooveSetUser(const int8_t *rgoff);
+BOOL	GrooveActive(void);
+const char *	GrooveName(WORD groove);
+
+//beat engine, Timer2 ISR: tick correction for each pulse of a beat
+// of period ticks; they add up to zero
+void	GrooveResolve(WORD period, int *rgdtck);
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,31 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-4-bit values to onboard LED masks, and showing them.         *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "config.h"
+#include "stdtypes.h"
+#include "led.h"
+
+/* ------------------------------------------------------------ */
+/*				Global Variables								*/
+/* ------------------------------------------------------------ */
+
+const HWORD	rgmskLed[16] = {
+	LED_MASK(0),	LED_MASK(1),	LED_MASK(2),	LED_MASK(3),
+	LED_MASK(4),	LED_MASK(5),	LED_MASK(6),	LED_MASK(7),
+	LED_MASK(8),	LED_MASK(9),	LED_MASK(10),	LED_MASK(11),
+	LED_MASK(12),	LED_MASK(13),	LED_MASK(14),	LED_MASK(15) };
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void LedShow(WORD v)
+{
+	HWORD	msk = LedMask(v);
+
+	latLedClr = LED_ALL & ~msk;
+	latLedSet = msk;
+}
@@ -0,0 +1,49 @@
+/************************************************************************/
+/*																		*/
+/*	led.h -- The four onboard LEDs as one mask							*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	A 4-bit value, LED1 the low bit, maps to the PORTB bits of the		*/
+/*	LEDs that show it.  LED_MASK() works it out at compile time, for	*/
+/*	tables such as the meter's accents; LedMask() looks it up in a		*/
+/*	16-entry table at run time.  Either way the mask goes to LATB in	*/
+/*	one write, so every LED in it changes on the same instruction.		*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_LED_INC)
+#define _LED_INC
+
+#include "config.h"
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	LED_MASK(v)			( ( ( (v) & 1 ) ? ( 1 << bnLed1 ) : 0 ) | \
+							  ( ( (v) & 2 ) ? ( 1 << bnLed2 ) : 0 ) | \
+							  ( ( (v) & 4 ) ? ( 1 << bnLed3 ) : 0 ) | \
+							  ( ( (v) & 8 ) ? ( 1 << bnLed4 ) : 0 ) )
+#define	LED_ALL				LED_MASK(0x0F)
+
+#define	LedMask(v)			( rgmskLed[(v) & 0x0F] )
+
+/* ------------------------------------------------------------ */
+/*					Variable Declarations						*/
+/* ------------------------------------------------------------ */
+
+extern const HWORD	rgmskLed[16];
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+//exactly the LEDs in v lit: one clear and one set
+void	LedShow(WORD v);
+
+/* ------------------------------------------------------------ */
+
+#endif
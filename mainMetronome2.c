@@ -14,6 +14,23 @@
 #include "config.h"
 #include "stdtypes.h"
 #include "LCD.h"
+#include "power.h"
+#include "battery.h"
+#include "soc.h"
+#include "governor.h"
+#include "beat.h"
+#include "audio.h"
+#include "midi.h"
+#include "tap.h"
+#include "meter.h"
+#include "poly.h"
+#include "led.h"
+#include "groove.h"
+#include "ramp.h"
+#include "sched.h"
+#include "preset.h"
+#include "rescue.h"
+#include "gesture.h"
 #include <stdio.h>
 
 /* ------------------------------------------------------------ */
@@ -28,11 +45,15 @@
 #define 	SIGNAL_ERROR       -1			// there's a problem
 #define 	SIGNAL_RESET        0			// clear the LEDs
 #define 	SIGNAL_BUTTON1      1			// please press button 1
-#define 	SIGNAL_BUTTON       2			// please press button 2
+#define 	SIGNAL_BUTTON2      2			// please press button 2
 #define 	SIGNAL_ROOT			3			// a root has been found
 #define 	SIGNAL_FINISHED     4			// we're done!
 #define 	BUTTON1				1			//
 #define 	BUTTON2				2			//
+#define		BUTTON_JE1			4			// PmodBTN (PMOD_BTN builds)
+#define		BUTTON_JE2			8
+#define		BUTTON_JE3			16
+#define		BUTTON_JE4			32
 #define 	TIME_FACTOR			1000		// 1 second; milliseconds to seconds
 #define 	LED_BLINK_COUNTER   4
 #define 	MAX_NUMBER 			15			// 4 LEDs can display this much; used in DisplayRandomLEDsequence().
@@ -40,6 +61,31 @@
 #define		stReleased			0			// button state: released
 #define		cstMaxCnt			10			// number of consecutive reads required for the state 
 											//of a button to be updated (implicit debouncing)
+#define		tusDebounce			( 80 * ( cstMaxCnt + 1 ) )	// press to stBtn change
+#define		BPM_MIN				20
+#define		BPM_MAX				300
+#define		MODE_TAP			0			// btn1 taps along
+#define		MODE_NUDGE			1			// btn1 slower, btn2 faster
+#define		MODE_RAMP			2			// practice ramp; buttons set the target
+#define		MODE_SET			3			// setlist; btn1 previous song, btn2 next
+#define		MODE_COUNT			4
+#define		RAMP_RISE			20			// default target above the start, BPM
+#define		RAMP_DBPM			2			// RAMP_STEP: BPM per step
+#define		RAMP_STEP_BARS		4			// RAMP_STEP: bars per step
+#define		RAMP_BARS			32			// RAMP_LINEAR, RAMP_EXP: bars to the target
+#define		COUNT_IN_BARS		1			// bars counted in before bar 1
+#define		REHEARSAL_BARS		8			// a new mark every so many bars, 0 = none
+#define		POS_LEN				7			// "A 12:3 " on the second row
+#define		POLY_PRESETS		4
+#define		FEEL_PRESETS		7
+#define		RESUME_BARS			8			// state held this long is kept for power-up
+#define		BOOT_LEAD_US		20000		// reset to first beat, less DeviceInit()
+#define		RESCUE_LEAD_US		2000		// shortest lead-in after a watchdog reset
+#define		SWT_CODES			16			// PmodSWT: JA1-JA4 as a 4-bit code
+#define		tmsSwitch			20			// between switch reads
+#define		cpressQueue			8			// Simon: presses not yet taken
+#define		SIMON_LEVELS		8			// score table rows, by DIFFICULTY
+#define		BeatTicksToUs(tck)	( ( (tck) * 2 ) / 5 )
 
 /* ------------------------------------------------------------ */
 /*				Configuration Pragmas							*/
@@ -48,13 +94,13 @@
 // Configuration Bit settings (written to Flash)
 // SYSCLK = 80 MHz (8MHz Crystal/ FPLLIDIV * FPLLMUL / FPLLODIV) = CPU FREQUENCY = 80000000L
 // 80 MHz requires:#pragma FPLLIDIV = DIV_2, FPLLMUL = MUL_20, FPLLODIV = DIV_1
-// PBCLK = 80 MHz
+// PBCLK = 10 MHz (FPBDIV = DIV_8)
 // Primary Osc w/PLL (XT+,HS+,EC+PLL)
-// WDT OFF
+// WDT ON, 64 ms (rescue.h)
 
 #ifndef OVERRIDE_CONFIG_BITS
 	#pragma config FPLLIDIV = DIV_2			// PLL Input Divider
-	#pragma config FPLLMUL  = MUL_16  		// was MUL_24
+	#pragma config FPLLMUL  = MUL_20  		// 80 MHz, as SYS_FREQ and power.c assume; was MUL_16
 	#pragma config FPLLODIV = DIV_1			// PLL Output Divider
  	#pragma config FPBDIV   = DIV_8			// Peripheral Clock divisor; was DIV_8
 	#pragma config ICESEL   = ICS_PGx2		// ICE/ICD Comm Channel Select
@@ -66,8 +112,8 @@
 	#pragma config POSCMOD  = HS			// Primary Oscillator
 	#pragma config OSCIOFNC = OFF			// CLKO Enable
 	#pragma config FCKSM    = CSDCMD		// Clock Switching & Fail Safe Clock Monitor
-	#pragma config WDTPS    = PS1			// Watchdog Timer Postscale
-	#pragma config FWDTEN   = OFF			// Watchdog Timer
+	#pragma config WDTPS    = PS64			// Watchdog Timer Postscale; was PS1
+	#pragma config FWDTEN   = ON			// Watchdog Timer; was OFF
 	#pragma config UPLLIDIV = DIV_2			// USB PLL Input Divider
 	#pragma config UPLLEN   = OFF			// USB PLL Enabled
 	#pragma config PWP      = OFF			// Program Flash Write Protect
@@ -86,10 +132,30 @@ struct btn {
 	BYTE	cst;	// number of consecutive reads of the same button state
 };
 
+struct press {
+	WORD	tck;	// BeatNow() time it really started
+	WORD	btn;	// BUTTON1 or BUTTON2
+};
+
+struct score {
+	WORD	usBest;	// quickest entry, 0 = none yet
+	WORD	usSum;	// average is usSum / centry
+	WORD	centry;
+};
+
 //new variables for Metronome project-------------------------------------------------
 
 volatile struct btn	btnBtn1;
 volatile struct btn	btnBtn2;
+#if defined(PMOD_BTN)
+volatile struct btn	rgbtnJE[4];			// PmodBTN, JE1-JE4
+#endif
+volatile WORD btnDown = 0;				//debounced BUTTON1.. bits; the debounce
+										// ISR's one store per pass, so a load
+										// is a consistent snapshot
+volatile struct press	rgpress[cpressQueue];	//every new press, for Simon
+volatile WORD ipressIn = 0;				//debounce ISR only
+volatile WORD ipressOut = 0;			//main loop only
 
 volatile unsigned int timerCount = 0;
 volatile unsigned int tempo = 0;
@@ -105,6 +171,67 @@ unsigned int tempCount;
 //LCD screen new variables------------------------------------------------------------
 char ans[5];
 
+//polyrhythm presets, after the meters in CycleMeter()'s list; hits per 4/4 bar on LED1-LED4
+const struct {
+	BYTE	rgn[POLY_VOICES];
+	char	sz[4];
+} rgpolyPreset[POLY_PRESETS] = {
+	{ { 4, 3, 0, 0 }, "3:4" },
+	{ { 4, 5, 0, 0 }, "5:4" },
+	{ { 2, 3, 0, 0 }, "3:2" },
+	{ { 4, 3, 5, 7 }, "357" },
+};
+WORD meterSel = METER_4_4;			//a meter, or METER_COUNT + a poly preset
+
+//subdivision and groove pairs for CycleMeter() in nudge mode
+const struct {
+	BYTE	sub;
+	BYTE	groove;
+	BYTE	pct;			// swing, for GROOVE_SWING8/16
+} rgfeelPreset[FEEL_PRESETS] = {
+	{ SUB_NONE,			GROOVE_STRAIGHT,	50 },
+	{ SUB_EIGHTH,		GROOVE_STRAIGHT,	50 },
+	{ SUB_EIGHTH,		GROOVE_SWING8,		58 },
+	{ SUB_EIGHTH,		GROOVE_SWING8,		67 },
+	{ SUB_TRIPLET,		GROOVE_STRAIGHT,	50 },
+	{ SUB_SIXTEENTH,	GROOVE_STRAIGHT,	50 },
+	{ SUB_SIXTEENTH,	GROOVE_SWING16,		58 },
+};
+WORD feelSel = 0;
+
+//meter and feel for each PmodSWT code (PMOD_SWT builds), SW1 the low
+// bit; code 0 leaves them to the front panel
+const struct {
+	BYTE	meter;			// index into meterSel
+	BYTE	feel;			// index into rgfeelPreset
+} rgswtPreset[SWT_CODES] = {
+	{ 0,			0 },
+	{ METER_4_4,	0 },
+	{ METER_4_4,	1 },
+	{ METER_4_4,	3 },
+	{ METER_4_4,	4 },
+	{ METER_4_4,	5 },
+	{ METER_3_4,	0 },
+	{ METER_3_4,	1 },
+	{ METER_3_4,	4 },
+	{ METER_2_4,	0 },
+	{ METER_2_4,	1 },
+	{ METER_2_4,	3 },
+	{ METER_6_8,	0 },
+	{ METER_6_8,	1 },
+	{ METER_7_8,	0 },
+	{ METER_7_8,	1 },
+};
+
+WORD modeSel = MODE_TAP;
+WORD rampKind = RAMP_STEP;			//RAMP_STEP, RAMP_LINEAR or RAMP_EXP
+int rampTarget = 0;					//BPM
+BOOL fTempoDirty = fFalse;			//top row wants redrawing (sched.h window)
+WORD songSel = 0;					//setlist song last recalled or saved
+int barBase = -COUNT_IN_BARS;		//bar number shown for barCount 0
+BOOL fSilent = fFalse;				//click sound off, LEDs only
+BOOL fPresetFull = fFalse;			//preset flash page full, saves held back
+
 //old variables for Simon Says assignment
 WORD BLINK_INTERVAL		= 200;		// milliseconds; used in SignalStatus(), DisplaySuccess().
 WORD DISPLAY_INTERVAL   = 1000;		// milliseconds; used in DisplayRandomLEDsequence().
@@ -112,7 +239,7 @@ WORD DIFFICULTY 		= 3;		//RANGE 1 TO MAX_SEQUENCES.
 									// Used in DisplayRandomLEDsequence(), AcceptInput().
 size_t MAX_SEQUENCES    = 3; 		// used in main()
 WORD RESPONSE_TIME		= 2000;		// milliseconds; used in AcceptInput().
-WORD REFLEX_TIME        = 500;      //ms, used for AcceptInput()
+struct score rgscore[SIMON_LEVELS];	// reaction times by DIFFICULTY; AcceptInput()
 
 /* ------------------------------------------------------------ */
 /*				Forward Declarations / Public interface			*/
@@ -126,19 +253,50 @@ BOOL 	SignalStatus(WORD status);
 // new...
 void InitializeButtons();
 WORD ButtonPressed();
+WORD ButtonState();
 void DisplaySuccess( BOOL success );
 void DisplayRandomLEDsequence(int *array);
 void AcceptInput(int *array);
+BOOL PressNext(WORD *pbtn, WORD *ptck);
+void PressClear(void);
+void ScoreEntry(WORD us);
 //LCD...
-void initADC( int amask);
-int readADC( int ch);
 char * intToString(long int num);
+//MIDI slave...
+void RunSlave(void);
+//live tempo changes...
+void ShowTempo(BOOL fAll);
+void NudgeTempo(int dbpm);
+void NudgeTask(void);
+void CycleMeter(void);
+void SetMode(WORD mode);
+void ShowPosition(void);
+void NudgeTarget(int dbpm);
+void StartRamp(void);
+void ApplyMeter(WORD sel);
+void ApplyFeel(WORD sel);
+void RecallSong(WORD song);
+void SaveSong(void);
+BOOL FResume(void);
+void ResumeTask(void);
+BOOL FRescue(void);
+void WatchTask(void);
+void SwitchTask(void);
 
 // ISRs ---------------------------------------------------
 
 void __ISR(_TIMER_5_VECTOR, ipl7) Timer5Handler(void)
 {
 	static	WORD tusLeds = 0;
+	BOOL	fEdge = fFalse;
+	WORD	btnJE = 0;
+	WORD	btn;
+	WORD	btnNew;
+	WORD	tck;
+#if defined(PMOD_BTN)
+	volatile struct btn	*pbtn;
+	WORD	ibtn;
+#endif
 
 	mT5ClearIntFlag();
 
@@ -156,15 +314,61 @@ void __ISR(_TIMER_5_VECTOR, ipl7) Timer5Handler(void)
 
 	// Update the state of button 1 if necessary.
 	if ( cstMaxCnt == btnBtn1.cst ) {
+		fEdge = ( btnBtn1.stBtn != btnBtn1.stCur );
 		btnBtn1.stBtn = btnBtn1.stCur;
 		btnBtn1.cst = 0;
 	}
 
 	// Update the state of button 2 if necessary.
 	if ( cstMaxCnt == btnBtn2.cst ) {
+		fEdge = fEdge || ( btnBtn2.stBtn != btnBtn2.stCur );
 		btnBtn2.stBtn = btnBtn2.stCur;
 		btnBtn2.cst = 0;
 	}
+
+#if defined(PMOD_BTN)
+	// The PmodBTN buttons, the same way; they too read high pressed.
+	rgbtnJE[0].stCur = ( prtJE1 & ( 1 << bnJE1 ) ) ? stPressed : stReleased;
+	rgbtnJE[1].stCur = ( prtJE2 & ( 1 << bnJE2 ) ) ? stPressed : stReleased;
+	rgbtnJE[2].stCur = ( prtJE3 & ( 1 << bnJE3 ) ) ? stPressed : stReleased;
+	rgbtnJE[3].stCur = ( prtJE4 & ( 1 << bnJE4 ) ) ? stPressed : stReleased;
+
+	for ( ibtn = 0; ibtn < 4; ibtn++ ) {
+		pbtn = &rgbtnJE[ibtn];
+		pbtn->cst = ( pbtn->stCur == pbtn->stPrev ) ? pbtn->cst + 1 : 0;
+		pbtn->stPrev = pbtn->stCur;
+		if ( cstMaxCnt == pbtn->cst ) {
+			fEdge = fEdge || ( pbtn->stBtn != pbtn->stCur );
+			pbtn->stBtn = pbtn->stCur;
+			pbtn->cst = 0;
+		}
+		if ( stPressed == pbtn->stBtn )
+			btnJE |= ( BUTTON_JE1 << ibtn );
+	}
+#endif
+
+	// Publish all of them at once; gestures are worked out in the
+	// main loop.
+	btn = ( ( stPressed == btnBtn1.stBtn ) ? BUTTON1 : 0 ) |
+		( ( stPressed == btnBtn2.stBtn ) ? BUTTON2 : 0 ) | btnJE;
+	btnNew = btn & ~btnDown & ( BUTTON1 | BUTTON2 );
+	btnDown = btn;
+	if ( !fEdge )
+		return;
+	tck = BeatNow() - BeatUsToTicks(tusDebounce);
+	GestureEdge(btn, tck);
+
+	// New presses queue up for Simon; a full queue drops them.
+	if ( ( btnNew & BUTTON1 ) && ipressIn - ipressOut < cpressQueue ) {
+		rgpress[ipressIn % cpressQueue].tck = tck;
+		rgpress[ipressIn % cpressQueue].btn = BUTTON1;
+		ipressIn++;
+	}
+	if ( ( btnNew & BUTTON2 ) && ipressIn - ipressOut < cpressQueue ) {
+		rgpress[ipressIn % cpressQueue].tck = tck;
+		rgpress[ipressIn % cpressQueue].btn = BUTTON2;
+		ipressIn++;
+	}
 }
 
 #define PB_DIV         		8
@@ -179,6 +383,9 @@ void __ISR(_TIMER_1_VECTOR, ipl2) Timer1Handler(void)
 
 	//increment the timer
 	++timerCount;
+
+	//kick off the next battery burst when it's due
+	BattTick();
 }
 
 // new metronome functions -------------------------------------------------
@@ -210,28 +417,12 @@ char * intToString(long int num)
 	return (char *)ans;
 }
 
-//for battery life display
-void initADC( int amask)
- {
- 	AD1PCFG = amask;		// select analog input pins
- 	AD1CON1 = 0x00E0;		// automatic conversion after sampling
- 	AD1CSSL = 0;			// no scanning required
- 	AD1CON2 = 0;			// use MUXA, use AVdd & AVss as Vref+/-
- 	AD1CON3 = 0x1F3F;		// Tsamp = 32 x Tad;
- 	AD1CON1bits.ADON = 1;	// turn on the ADC
-
- }
-
-int readADC( int ch)
-{
-	AD1CHSbits.CH0SA = ch;		// 1. select input channel
-	AD1CON1bits.SAMP = 1;		// 2. start sampling
- 	while (!AD1CON1bits.DONE);	// 3. wait conversion
- 	return ADC1BUF0;			// 4. read conversion result
-}
-
 //put initial values into volatile button structs
 void InitializeButtons() {
+#if defined(PMOD_BTN)
+	WORD	ibtn;
+#endif
+
 	// Initialize the state of button 1.
 	btnBtn1.stBtn 	= stReleased;
 	btnBtn1.stCur 	= stReleased;
@@ -243,19 +434,49 @@ void InitializeButtons() {
 	btnBtn2.stCur 	= stReleased;
 	btnBtn2.stPrev 	= stReleased;
 	btnBtn2.cst		= 0;
+
+#if defined(PMOD_BTN)
+	for ( ibtn = 0; ibtn < 4; ibtn++ ) {
+		rgbtnJE[ibtn].stBtn		= stReleased;
+		rgbtnJE[ibtn].stCur		= stReleased;
+		rgbtnJE[ibtn].stPrev	= stReleased;
+		rgbtnJE[ibtn].cst		= 0;
+	}
+#endif
 }
 
 //configure timers, LEDs
 void DeviceInit() {
+	//before anything can hang: the watchdog is already running
+	RescueInit();
+
 	InitializeButtons();
 
-	//for LCD
-	initADC(4);
-   	initLCD();	
+	//battery sampling runs in the background from here on
+	BattInit();
+	SocInit(SOC_ALKALINE);
+	BeatInit();
+	SchedInit();
+	MeterInit();
+	GrooveInit();
+	RampInit();
+	PolyInit();
+	AudioInit();
+	MidiInit();
+	TapInit();
+	GestureInit();
+	GovInit();
+	PresetInit();
 
 	// Configure onboard buttons as inputs.
 	trisBtn1Set = ( 1 << bnBtn1 );
 	trisBtn2Set = ( 1 << bnBtn2 );
+#if defined(PMOD_BTN)
+	trisJE1Set = ( 1 << bnJE1 );
+	trisJE2Set = ( 1 << bnJE2 );
+	trisJE3Set = ( 1 << bnJE3 );
+	trisJE4Set = ( 1 << bnJE4 );
+#endif
 
 	// Configure LEDs as digital outputs.
 	trisLed1Clr = ( 1 << bnLed1 );
@@ -264,14 +485,11 @@ void DeviceInit() {
 	trisLed4Clr = ( 1 << bnLed4 );
 
 	// Turn off the LEDs.
-	prtLed1Clr	= ( 1 << bnLed1 );
-	prtLed2Clr	= ( 1 << bnLed2 );
-	prtLed3Clr	= ( 1 << bnLed3 );
-	prtLed4Clr	= ( 1 << bnLed4 );
+	ClearAllLEDs();
 
 	// Configure Timer 5.
 	TMR5	= 0;
-	PR5		= 99; // period match every 100 us
+	PR5		= 99; // period match every 80 us (10 MHz / 8 * 100)
 	//interrupt priority level 7, sub 3
 	IPC5SET	= ( 1 << 4 ) | ( 1 << 3 ) | ( 1 << 2 ) | ( 1 << 1 ) | ( 1 << 0 );
 	IFS0CLR = ( 1 << 20);
@@ -293,6 +511,7 @@ void DeviceInit() {
 void Wait_ms( WORD tmsDelay )
 {
 	while ( 0 < tmsDelay ) {
+		RescueKick();
 		DelayUs(TIME_FACTOR);
 		tmsDelay--;
 	}
@@ -312,22 +531,17 @@ void DelayUs( WORD tusDelay )
 
 void ClearAllLEDs(void)
 {
-	prtLed1Clr	= ( 1 << bnLed1 );
-	prtLed2Clr	= ( 1 << bnLed2 );
-	prtLed3Clr	= ( 1 << bnLed3 );
-	prtLed4Clr	= ( 1 << bnLed4 );
+	latLedClr = LED_ALL;
 }
 
+//each status adds its LEDs to those already lit, in one write
 BOOL SignalStatus(WORD status)
 {
 	switch (status) {
 		case SIGNAL_ERROR : { // blink all LEDs
 			WORD i = 0;
 			for (i = 0; i < LED_BLINK_COUNTER; i++) {
-				prtLed1Set = (1 << bnLed1);
-				prtLed2Set = (1 << bnLed2);
-				prtLed3Set = (1 << bnLed3);
-				prtLed4Set = (1 << bnLed4);
+				latLedSet = LED_ALL;
 				Wait_ms(BLINK_INTERVAL);
 				ClearAllLEDs();
 				Wait_ms(BLINK_INTERVAL);
@@ -339,31 +553,21 @@ BOOL SignalStatus(WORD status)
 			ClearAllLEDs();
 			break;
 
-		case SIGNAL_BUTTON1 : { // steady 1 LED
-			prtLed1Set = (1 << bnLed1);
+		case SIGNAL_BUTTON1 : // steady 1 LED
+			latLedSet = LedMask(0x1);
 			break;
-		}
 
-		case SIGNAL_BUTTON2 : { // steady 2 LEDs
-			//prtLed1Set = (1 << bnLed1);
-			prtLed2Set = (1 << bnLed2);
+		case SIGNAL_BUTTON2 : // steady 2 LEDs
+			latLedSet = LedMask(0x2);
 			break;
-		}
 
-		case SIGNAL_ROOT : { // steady 3 LEDs
-			prtLed1Set = (1 << bnLed1);
-			prtLed2Set = (1 << bnLed2);
-			prtLed3Set = (1 << bnLed3);
+		case SIGNAL_ROOT : // steady 3 LEDs
+			latLedSet = LedMask(0x7);
 			break;
-		}
 
-		case SIGNAL_FINISHED: { // steady 4 LEDs
-			prtLed1Set = (1 << bnLed1);
-			prtLed2Set = (1 << bnLed2);
-			prtLed3Set = (1 << bnLed3);
-			prtLed4Set = (1 << bnLed4);
-		break;
-		}
+		case SIGNAL_FINISHED: // steady 4 LEDs
+			latLedSet = LED_ALL;
+			break;
 
 		default : return fFalse;
 	}
@@ -407,58 +611,8 @@ void DisplayRandomLEDsequence(int *array)
                     array[i] = rand() % MAX_NUMBER;
 		} while (array[i] <= 0);
 
-            // display values as (binary) LEDs
-		switch (array[i])
-		{
-		  case 0 : 	break;
-		  case 1 : 	prtLed1Set = (1 << bnLed1);		// 1
-				break;
-		  case 2 : 	prtLed2Set = (1 << bnLed2);		// 2
-				break;
-		  case 3 : 	prtLed1Set = (1 << bnLed1);		// 1
-				prtLed2Set = (1 << bnLed2);			// 2
-				break;
-		  case 4 : 	prtLed3Set = (1 << bnLed3);		// 4
-				break;
-		  case 5 : 	prtLed3Set = (1 << bnLed3);		// 4
-				prtLed1Set = (1 << bnLed1);			// 1
-				break;
-		  case 6 : 	prtLed3Set = (1 << bnLed3);		// 4
-				prtLed2Set = (1 << bnLed2);			// 2
-				break;
-		  case 7 : 	prtLed3Set = (1 << bnLed3);		// 4
-				prtLed2Set = (1 << bnLed2);			// 2
-				prtLed1Set = (1 << bnLed1);			// 1
-				break;
-		  case 8 : 	prtLed4Set = (1 << bnLed4);		// 8
-				break;
-		  case 9 : 	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed1Set = (1 << bnLed1);			// 1
-				break;
-		  case 10:	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed2Set = (1 << bnLed2);			// 2
-				break;
-		  case 11:	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed2Set = (1 << bnLed2);			// 2
-				prtLed1Set = (1 << bnLed1);			// 1
-				break;
-		  case 12:	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed3Set = (1 << bnLed3);			// 4
-				break;
-		  case 13:	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed3Set = (1 << bnLed3);			// 4
-				prtLed1Set = (1 << bnLed1);			// 1
-				break;
-		  case 14:	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed3Set = (1 << bnLed3);			// 4
-				prtLed2Set = (1 << bnLed2);			// 2
-				break;
-		  case 15:	prtLed4Set = (1 << bnLed4);		// 8
-				prtLed3Set = (1 << bnLed3);			// 4
-				prtLed2Set = (1 << bnLed2);			// 2
-				prtLed1Set = (1 << bnLed1);			// 1
-				break;
-		} // switch
+            // display values as (binary) LEDs, all at once
+		LedShow(array[i]);
 		Wait_ms(DISPLAY_INTERVAL);
 		ClearAllLEDs();
 	}	// for (i)
@@ -470,52 +624,103 @@ void DisplayRandomLEDsequence(int *array)
 //only returns 1, 2 or 3
 WORD ButtonPressed()
 {
-	BYTE	stBtn1 = 0;
-	BYTE	stBtn2 = 0;
+	WORD	btn;
 
 	//InitializeButtons();
-	while ((stBtn1 + stBtn2) < 1)
-	{
-		INTDisableInterrupts();
-		stBtn1 = btnBtn1.stBtn;
-		stBtn2 = btnBtn2.stBtn;
-		INTEnableInterrupts();
-	}
+	//the watchdog is short, so keep it fed while nobody presses anything
+	while ((btn = ButtonState()) == 0)
+		RescueKick();
 
-	if ((stPressed == stBtn1) && (stPressed == stBtn2))
-		return BUTTON1 + BUTTON2;
-	if (stPressed == stBtn1)
-		return BUTTON1;
-	if (stPressed == stBtn2)
-		return BUTTON2;
-	return 0;
+	return btn;
+}
+
+//like ButtonPressed(), but returns 0 at once if nothing is pressed;
+// one load of btnDown, no interrupt masking
+WORD ButtonState()
+{
+	return btnDown & ( BUTTON1 | BUTTON2 );
+}
+
+//oldest press not yet taken, with the BeatNow() time it started
+BOOL PressNext(WORD *pbtn, WORD *ptck)
+{
+	if(ipressOut == ipressIn)
+		return fFalse;
+	*pbtn = rgpress[ipressOut % cpressQueue].btn;
+	*ptck = rgpress[ipressOut % cpressQueue].tck;
+	ipressOut++;
+	return fTrue;
+}
+
+//drops presses from before a prompt
+void PressClear(void)
+{
+	ipressOut = ipressIn;
+}
+
+//one entry's reaction time into the row for this DIFFICULTY
+void ScoreEntry(WORD us)
+{
+	WORD	level = ( DIFFICULTY < SIMON_LEVELS ) ? DIFFICULTY : SIMON_LEVELS - 1;
+	struct score	*pscore = &rgscore[level];
+
+	if(pscore->usBest == 0 || us < pscore->usBest)
+		pscore->usBest = us;
+	pscore->usSum += us;
+	pscore->centry++;
 }
 
 /* ------------------------------------------------------------ */
 // With 4 LEDS, can input from 1 to 15 using button1 as a counter,
-// and button2 as "enter"
-//uses REFLEX_TIME as "debouncing" so user doesn't accidentally
-// enter a larger number
+// and button2 as "enter".  Presses come from the debounce ISR's queue
+// with the time each really started, so none is missed however quick.
+// An entry's reaction time runs from the prompt, or the last enter,
+// to its first press; an entry left RESPONSE_TIME without a press is
+// entered as it stands.
 void AcceptInput(int *array)
 {
-    int but1count = 0, but2count = 0;
+	WORD	ientry = 0;
+	int		cbtn1 = 0;
+	BOOL	fFirst = fTrue;
+	WORD	tckPrompt;
+	WORD	tckLast;
+	WORD	btn;
+	WORD	tck;
+
+	PressClear();
+	tckPrompt = tckLast = BeatNow();
+
+	while(ientry < DIFFICULTY)
+	{
+		RescueKick();
 
-    while(but2count < DIFFICULTY)
-    {
-        but1count = 0;
-        while(ButtonPressed() != 2)
-        {
-            if(ButtonPressed() == 1)
-            {
-                but1count = but1count + 1;
-                Wait_ms(REFLEX_TIME);
-            }
-        }
-        array[but2count] = but1count;
-        but2count = but2count + 1;
-
-        Wait_ms(REFLEX_TIME);
-    }
+		if(PressNext(&btn, &tck))
+		{
+			tckLast = tck;
+			if(fFirst)
+				ScoreEntry(BeatTicksToUs(tck - tckPrompt));
+			fFirst = fFalse;
+		}
+		else if(BeatNow() - tckLast >= BeatUsToTicks(RESPONSE_TIME * 1000))
+		{
+			//no reaction to score
+			btn = BUTTON2;
+			tck = tckLast = BeatNow();
+		}
+		else
+			continue;
+
+		if(btn == BUTTON1)
+		{
+			cbtn1++;
+			continue;
+		}
+
+		array[ientry++] = cbtn1;
+		cbtn1 = 0;
+		fFirst = fTrue;
+		tckPrompt = tck;
+	}
 }
 
 /* ------------------------------------------------------------ */
@@ -533,53 +738,635 @@ BOOL compArrs(int randArr [], int userArr[])
 }
 
 /* ------------------------------------------------------------ */
-//user must hold down button 1 for a pseudo random
-// seed value.  Uses user's "slow" reflexes compared
-// to time granularity of chip.
-//this resulted from the mistakes of making the AcceptInput()
-// function, because the but1count value was in the thousands
-// after one click!
+//a pseudo random seed from when the user presses button 2: the
+// press time is kept to 0.4 us, far finer than anyone's reflexes
 int getSeed(void)
 {
-    int userSeed = 0;
+	WORD	btn;
+	WORD	tck;
 
-    while(ButtonPressed() != 2 || userSeed == 0)
-    {
-        if(ButtonPressed() == 1)
-            ++userSeed;
-    }
-    return userSeed;
+	PressClear();
+	while(!PressNext(&btn, &tck) || btn != BUTTON2)
+		RescueKick();
+	return (int)( tck | 1 );
+}
+
+/* ------------------------------------------------------------ */
+// Top row is "BPM 120 7/8t tap": tempo, meter, subdivision (e, t or
+// s, capital when swung) and mode, in capitals with the click sound
+// off.  While ramping, "BPM 120 >160 lin" has the target and the ramp
+// kind instead, and in the setlist it is " 3 Song  3  120": song
+// number, name and tempo, or "full" while the preset page is full and
+// saves wait for the beat to stop.  Only the fields are ever
+// rewritten, so a nudge costs a few characters, not a clrLCD().
+void ShowTempo(BOOL fAll)
+{
+	static const char rgchSub[SUB_COUNT] = { ' ', 'e', 't', 's' };
+	char	sz[24];
+	char	chSub = rgchSub[MeterGetSub()];
+	WORD	period = BeatGetPeriod();
+	struct preset	pre;
+	WORD	ich;
+
+	if(modeSel == MODE_SET)
+	{
+		PresetGet(songSel, &pre);
+		if(fPresetFull)
+			sprintf(sz, "%2d %-8s full", (int)( songSel + 1 ) % 100, pre.szName);
+		else
+			sprintf(sz, "%2d %-8s %3d ", (int)( songSel + 1 ) % 100, pre.szName,
+				(int)( period ? BeatPeriodToBpm(period) : 0 ) % 1000);
+		cmdLCD(0x80 | 0x00);
+		putsLCD(sz);
+		return;
+	}
+
+	if(fAll)
+	{
+		cmdLCD(0x80 | 0x00);
+		putsLCD("BPM ");
+	}
+	sprintf(sz, "%3d", (int)( period ? BeatPeriodToBpm(period) : 0 ));
+	cmdLCD(0x80 | 0x04);
+	putsLCD(sz);
+	if(modeSel == MODE_RAMP)
+		sprintf(sz, ">%3d", rampTarget);
+	else if(meterSel >= METER_COUNT)
+		sprintf(sz, "%s ", rgpolyPreset[meterSel - METER_COUNT].sz);
+	else
+	{
+		if(GrooveGet() != GROOVE_STRAIGHT && chSub != ' ')
+			chSub -= 'a' - 'A';
+		sprintf(sz, "%s%c", MeterName(MeterGet()), chSub);
+	}
+	cmdLCD(0x80 | 0x08);
+	putsLCD(sz);
+	cmdLCD(0x80 | 0x0D);
+	sprintf(sz, "%s", ( modeSel == MODE_RAMP ) ? RampName(rampKind) :
+		( modeSel == MODE_TAP ) ? "tap" : "adj");
+	for(ich = 0; fSilent && sz[ich] != '\0'; ich++)
+		if(sz[ich] >= 'a' && sz[ich] <= 'z')
+			sz[ich] -= 'a' - 'A';
+	putsLCD(sz);
+}
+
+// Left part of the second row, "A 12:3 ": rehearsal mark, bar and
+// beat; "in  1:3 " during the count-in.  It is drawn once per beat in
+// the I/O window after the beat (sched.h), and only the characters
+// that changed are written, usually just the beat digit.  The MIDI
+// Start goes out with bar 1.
+void ShowPosition(void)
+{
+	static char	szShown[POS_LEN + 1] = "       ";
+	static WORD	beatShown = 0;
+	char	sz[24];
+	unsigned int intStat;
+	WORD	cbar;
+	WORD	ipulse;
+	WORD	cbeat;
+	WORD	beat;
+	int		bar;
+	WORD	ich;
+	BOOL	fAddr = fFalse;
+
+	if(beatCount == beatShown || !SchedIoWindow())
+		return;
+	beatShown = beatCount;
+
+	intStat = INTDisableInterrupts();
+	cbar = barCount;
+	ipulse = barPulse;
+	INTRestoreInterrupts(intStat);
+
+	cbeat = BeatGetBar()->cbeat;
+	beat = ipulse / BEAT_PPQN + 1;
+	bar = (int)cbar + barBase;
+
+	//the last beat of the count-in: Start goes out on the next downbeat
+	if(COUNT_IN_BARS != 0 && bar == 0 && beat == cbeat)
+		MidiStart();
+
+	//nothing to show in the lead-in beat
+	if(beatCount == 0)
+		return;
+
+	if(bar <= 0)
+		sprintf(sz, "in%2d:%d ", (int)( cbar % 100 ), (int)( beat % 10 ));
+	else
+		sprintf(sz, "%c%3d:%d ", ( REHEARSAL_BARS != 0 ) ?
+			'A' + ( ( bar - 1 ) / REHEARSAL_BARS ) % 26 : ' ', bar % 1000, (int)( beat % 10 ));
+
+	for(ich = 0; ich < POS_LEN; ich++)
+	{
+		if(sz[ich] == szShown[ich])
+		{
+			fAddr = fFalse;
+			continue;
+		}
+		if(!fAddr)
+			cmdLCD(0x80 | ( 0x40 + ich ));
+		putLCD(sz[ich]);
+		szShown[ich] = sz[ich];
+		fAddr = fTrue;
+	}
+}
+
+// Tap-along, nudging, ramping and the setlist take turns on the two
+// buttons.  A ramp starts from the tempo as it is, RAMP_RISE BPM
+// short of the top.
+void SetMode(WORD mode)
+{
+	int	bpm = BeatPeriodToBpm(BeatGetPeriodNext());
+
+	modeSel = mode;
+	TapSetTracking(mode == MODE_TAP);
+	//btn2 singles do nothing here or aren't urgent, so they can wait
+	// for a double tap
+	GestureSetDouble(( mode == MODE_TAP || mode == MODE_SET ) ? BUTTON2 : 0);
+	if(mode == MODE_RAMP)
+	{
+		rampTarget = bpm + RAMP_RISE;
+		if(rampTarget > BPM_MAX)
+			rampTarget = BPM_MAX;
+		StartRamp();
+	}
+	else
+		RampStop();
+	fTempoDirty = fTrue;
+}
+
+// (Re)start the ramp from the current tempo towards rampTarget.
+void StartRamp(void)
+{
+	if(rampTarget < BPM_MIN)
+		rampTarget = BPM_MIN;
+	if(rampTarget > BPM_MAX)
+		rampTarget = BPM_MAX;
+	RampStart(rampKind, rampTarget, RAMP_DBPM,
+		( rampKind == RAMP_STEP ) ? RAMP_STEP_BARS : RAMP_BARS);
+}
+
+// Holding both buttons steps through the meters and then the
+// polyrhythm presets in tap and setlist mode, the subdivision and
+// swing presets in nudge mode and the ramp kinds in ramp mode.  The
+// change starts at the next bar line.
+void CycleMeter(void)
+{
+	if(modeSel == MODE_RAMP)
+	{
+		rampKind = ( rampKind == RAMP_EXP ) ? RAMP_STEP : rampKind + 1;
+		StartRamp();
+		fTempoDirty = fTrue;
+		return;
+	}
+
+	if(modeSel == MODE_NUDGE)
+		ApplyFeel(( feelSel + 1 ) % FEEL_PRESETS);
+	else
+		ApplyMeter(( meterSel + 1 ) % ( METER_COUNT + POLY_PRESETS ));
+	fTempoDirty = fTrue;
+}
+
+// A meter, or METER_COUNT + a polyrhythm preset.
+void ApplyMeter(WORD sel)
+{
+	WORD	voice;
+
+	meterSel = sel;
+	if(meterSel < METER_COUNT)
+	{
+		PolyEnable(fFalse);
+		MeterSet(meterSel, MeterGetSub());
+	}
+	else
+	{
+		//the voices share out a plain 4/4 bar
+		MeterSet(METER_4_4, MeterGetSub());
+		for(voice = 0; voice < POLY_VOICES; voice++)
+			PolySetVoice(voice, rgpolyPreset[meterSel - METER_COUNT].rgn[voice]);
+		PolyEnable(fTrue);
+	}
+}
+
+void ApplyFeel(WORD sel)
+{
+	feelSel = sel;
+	GrooveSetSwing(rgfeelPreset[feelSel].pct);
+	GrooveSet(rgfeelPreset[feelSel].groove);
+	MeterSet(MeterGet(), rgfeelPreset[feelSel].sub);
+}
+
+// Tempo from the next beat, meter and feel from the next bar line.
+// Fields out of range, e.g. from a damaged record, fall back to the
+// defaults.
+void RecallSong(WORD song)
+{
+	struct preset	pre;
+	WORD	bpm;
+
+	PresetGet(song, &pre);
+	bpm = pre.bpm;
+	if(bpm < BPM_MIN || bpm > BPM_MAX)
+		bpm = 120;
+	BeatSetPeriod(BeatBpmToPeriod(bpm));
+	ApplyFeel(( pre.feel < FEEL_PRESETS ) ? pre.feel : 0);
+	ApplyMeter(( pre.meter < METER_COUNT + POLY_PRESETS ) ? pre.meter : METER_4_4);
+	songSel = song;
+	PresetSetCurrent(song);
+	fTempoDirty = fTrue;
+}
+
+// The song keeps its name and takes what is playing now.
+void SaveSong(void)
+{
+	struct preset	pre;
+
+	PresetGet(songSel, &pre);
+	pre.bpm = BeatPeriodToBpm(BeatGetPeriodNext());
+	pre.meter = meterSel;
+	pre.feel = feelSel;
+	PresetSave(songSel, &pre);
+	PresetSetCurrent(songSel);
+	fTempoDirty = fTrue;
+}
+
+// Fast boot: the state ResumeTask() kept last time starts clicking
+// BOOT_LEAD_US from now, before the LCD is even up.  Holding btn2
+// through reset asks for taps instead.
+BOOL FResume(void)
+{
+	struct preset	pre;
+	WORD	mode;
+
+	if(!PresetGetResume(&pre, &mode) || ( prtBtn2 & ( 1 << bnBtn2 ) ))
+		return fFalse;
+	if(pre.bpm < BPM_MIN || pre.bpm > BPM_MAX || mode >= MODE_COUNT)
+		return fFalse;
+
+	ApplyFeel(( pre.feel < FEEL_PRESETS ) ? pre.feel : 0);
+	ApplyMeter(( pre.meter < METER_COUNT + POLY_PRESETS ) ? pre.meter : METER_4_4);
+	if(PresetGetCurrent() != PRESET_NONE)
+		songSel = PresetGetCurrent();
+
+	AudioEnable(fTrue);
+	MidiSetMode(MIDI_OUT);
+	if(COUNT_IN_BARS == 0)
+		MidiStart();
+	BeatStartIn(BeatBpmToPeriod(pre.bpm), BeatUsToTicks(BOOT_LEAD_US), 0);
+	SetMode(mode);
+	return fTrue;
+}
+
+// What is playing goes to flash for the next power-up once it has
+// held for RESUME_BARS bars.  A running ramp waits till it is done.
+void ResumeTask(void)
+{
+	static WORD	barSeen = 0;
+	static struct preset	preLast;
+	static WORD	modeLast = MODE_COUNT;
+	struct preset	pre;
+
+	if(barCount == barSeen || ( barCount % RESUME_BARS ) != 0)
+		return;
+	barSeen = barCount;
+
+	pre.szName[0] = '\0';
+	pre.bpm = BeatPeriodToBpm(BeatGetPeriodNext());
+	pre.meter = meterSel;
+	pre.feel = feelSel;
+	if(!RampRunning() && modeSel == modeLast && pre.bpm == preLast.bpm &&
+			pre.meter == preLast.meter && pre.feel == preLast.feel)
+		PresetSetResume(&pre, modeSel);
+	preLast = pre;
+	modeLast = modeSel;
+}
+
+// After a watchdog reset the beat comes back on the grid it left.
+// The last snapshot says where it was when the main loop last got
+// round, and the watchdog period plus the boot so far how long ago
+// that was.  The first beat is at least RESCUE_LEAD_US away.
+BOOL FRescue(void)
+{
+	struct rescue	res;
+	WORD	tckSince;
+	WORD	tckLead;
+	WORD	beat;
+
+	if(!RescueGet(&res) || res.period == 0 || res.cbeat == 0 || res.mode >= MODE_COUNT)
+		return fFalse;
+
+	ApplyFeel(( res.feel < FEEL_PRESETS ) ? res.feel : 0);
+	ApplyMeter(( res.meter < METER_COUNT + POLY_PRESETS ) ? res.meter : METER_4_4);
+	songSel = ( res.song < PRESET_SONGS ) ? res.song : 0;
+
+	//the core timer counts SYSCLK / 2 from reset
+	tckSince = res.tckSince + BeatUsToTicks(RESCUE_WDT_US +
+		ReadCoreTimer() / ( SYS_FREQ / 2000000 ));
+	beat = res.beat + tckSince / res.period + 1;
+	tckLead = res.period - tckSince % res.period;
+	if(tckLead < BeatUsToTicks(RESCUE_LEAD_US))
+	{
+		tckLead += res.period;
+		beat++;
+	}
+	//a downbeat first is bar 1 to the engine, anything else bar 0
+	barBase = res.bar + beat / res.cbeat - ( ( beat % res.cbeat ) == 0 ? 1 : 0 );
+
+	AudioEnable(fTrue);
+	MidiSetMode(MIDI_OUT);
+	BeatStartIn(res.period, tckLead, beat % res.cbeat);
+	SetMode(res.mode);
+	if(res.mode == MODE_RAMP)
+	{
+		rampTarget = res.bpmTarget;
+		StartRamp();
+	}
+	return fTrue;
+}
+
+// Clears the watchdog, with a note of where the beat is for FRescue().
+void WatchTask(void)
+{
+	struct rescue	res;
+	unsigned int intStat;
+	WORD	cbar;
+	WORD	ipulse;
+
+	intStat = INTDisableInterrupts();
+	res.tckSince = BeatNow() - BeatLastBeat();
+	cbar = barCount;
+	ipulse = barPulse;
+	INTRestoreInterrupts(intStat);
+
+	res.period = BeatGetPeriod();
+	res.bar = (int)cbar + barBase;
+	res.beat = ipulse / BEAT_PPQN;
+	res.cbeat = BeatGetBar()->cbeat;
+	res.bpmTarget = rampTarget;
+	res.meter = meterSel;
+	res.feel = feelSel;
+	res.mode = modeSel;
+	res.song = songSel;
+	RescueSave(&res);
+}
+
+// The beat engine takes the new period at the next beat boundary, so
+// the beat in progress finishes at the old tempo: no double blip, no
+// skipped beat.
+void NudgeTempo(int dbpm)
+{
+	int	bpm = BeatPeriodToBpm(BeatGetPeriodNext()) + dbpm;
+
+	if(bpm < BPM_MIN)
+		bpm = BPM_MIN;
+	if(bpm > BPM_MAX)
+		bpm = BPM_MAX;
+	BeatSetPeriod(BeatBpmToPeriod(bpm));
+}
+
+// A new target restarts the ramp from the tempo as it is now.
+void NudgeTarget(int dbpm)
+{
+	rampTarget += dbpm;
+	StartRamp();
+	fTempoDirty = fTrue;
+}
+
+// Polled from the main loop; acts on gestures (gesture.h).  Both
+// buttons together step through tap-along, nudging, ramping and the
+// setlist, or held, change the meter (CycleMeter()).  In nudge mode a
+// short press is 1 BPM and a long one 10, slower on btn1 and faster
+// on btn2; in ramp mode the same presses move the target and restart
+// the ramp.  In the setlist a short press steps back or on a song and
+// a long one saves what is playing into the current one.  In tap and
+// setlist mode a double tap on btn2 turns the click sound off or on.
+// The PmodBTN does the same in any mode: JE1/JE2 nudge slower and
+// faster, JE3/JE4 recall the previous and next song.
+void NudgeTask(void)
+{
+	WORD	ev;
+	WORD	btn;
+	int		dir;
+
+	while((ev = GestureNext()) != GEST_NONE)
+	{
+		btn = GestButtons(ev);
+		dir = ( btn == BUTTON2 || btn == BUTTON_JE2 || btn == BUTTON_JE4 ) ? 1 : -1;
+
+		// a tap is a short press of btn1 alone, timed from its press;
+		// chords and long presses leave the beat be
+		if(btn == BUTTON1 && GestKind(ev) == GEST_SHORT)
+			TapPress(GestureTime());
+
+		if(btn == BUTTON_JE1 || btn == BUTTON_JE2)
+			NudgeTempo(( GestKind(ev) == GEST_LONG ) ? 10 * dir : dir);
+		else if(btn == BUTTON_JE3 || btn == BUTTON_JE4)
+			RecallSong(( songSel + PRESET_SONGS + dir ) % PRESET_SONGS);
+		else if(btn & ~( BUTTON1 | BUTTON2 ))
+			;	// other chords with the PmodBTN do nothing
+		else if(btn == BUTTON1 + BUTTON2)
+		{
+			if(GestKind(ev) == GEST_LONG)
+				CycleMeter();
+			else
+				SetMode(( modeSel + 1 ) % MODE_COUNT);
+		}
+		else if(GestKind(ev) == GEST_DOUBLE)
+		{
+			fSilent = !fSilent;
+			AudioEnable(!fSilent);
+			fTempoDirty = fTrue;
+		}
+		else if(GestKind(ev) == GEST_LONG)
+		{
+			if(modeSel == MODE_NUDGE)
+				NudgeTempo(10 * dir);
+			else if(modeSel == MODE_RAMP)
+				NudgeTarget(10 * dir);
+			else if(modeSel == MODE_SET)
+				SaveSong();
+		}
+		else if(modeSel == MODE_NUDGE)
+			NudgeTempo(dir);
+		else if(modeSel == MODE_RAMP)
+			NudgeTarget(dir);
+		else if(modeSel == MODE_SET)
+			RecallSong(( songSel + PRESET_SONGS + dir ) % PRESET_SONGS);
+	}
 }
 
-void timer1Wait(unsigned int theTempo)
+// Polled from the main loop.  A PmodSWT code takes over the meter and
+// feel once it has read the same twice running; while it stays put the
+// front panel can still change them.  JA is also the LCD data bus, so
+// the switches are read with the PMP idled, in the I/O window.
+void SwitchTask(void)
 {
-	timerCount=0;	
+#if defined(PMOD_SWT)
+	static WORD	tmsRead = 0;
+	static WORD	codeRead = 0;
+	static WORD	codeSet = 0;
+	WORD	code;
+
+	if(timerCount - tmsRead < tmsSwitch || !SchedIoWindow())
+		return;
+	tmsRead = timerCount;
+
+	idleLCD();
+	code = ( prtSwt >> bnSwt ) & ( SWT_CODES - 1 );
+	if(code != codeRead)
+	{
+		codeRead = code;
+		return;
+	}
+	if(code == codeSet)
+		return;
+
+	codeSet = code;
+	if(code == 0)
+		return;
+	ApplyFeel(rgswtPreset[code].feel);
+	ApplyMeter(rgswtPreset[code].meter);
+	fTempoDirty = fTrue;
+#endif
+}
+
+/* ------------------------------------------------------------ */
+// Follow an external MIDI clock; never returns.  The beat engine is
+// started right after a master beat so its first beat lands on the
+// next one, and from then on the PLL in midi.c steers it.
+void RunSlave(void)
+{
+	BOOL	fBeating = fFalse;
+	WORD	cbeat;
+	WORD	bpm10;
+	WORD	bpm10Shown = 0;
+	WORD	cbeatShown = 0;
+	char	sz[24];
+
+	clrLCD();
+	putsLCD("MIDI clock");
+
+	AudioEnable(fTrue);
+	PowerEnterRun();
 
 	while(1)
 	{
-		if(timerCount >= theTempo)
-			break;
+		if(!fBeating && MidiSlaveLocked() && MidiSlaveRunning())
+		{
+			cbeat = MidiSlaveBeats();
+			while(MidiSlaveBeats() == cbeat && MidiSlaveRunning())
+			{
+				RescueKick();
+				PowerIdle();
+			}
+			BeatStart(MidiSlavePeriod());
+			MidiSlaveFollow(fTrue);
+			fBeating = fTrue;
+		}
+		else if(fBeating && !MidiSlaveRunning())
+		{
+			MidiSlaveFollow(fFalse);
+			BeatStop();
+			fBeating = fFalse;
+		}
+
+		//tracked tempo on the top row, looked at once a beat and
+		// redrawn only when it moves, in the gap after our own beat
+		bpm10 = MidiSlaveLocked() ? MidiSlaveBpm10() : 0;
+		if(bpm10 != bpm10Shown && ( MidiSlaveBeats() != cbeatShown || bpm10 == 0 ) &&
+			SchedIoWindow())
+		{
+			cbeatShown = MidiSlaveBeats();
+			bpm10Shown = bpm10;
+			if(bpm10 != 0)
+				sprintf(sz, "MIDI %3d.%d BPM ", (int)( bpm10 / 10 ), (int)( bpm10 % 10 ));
+			else
+				strcpy(sz, "MIDI --- BPM   ");
+			cmdLCD(0x80 | 0x00);
+			putsLCD(sz);
+		}
+
+		PowerIdle();
+		RescueKick();
+		SocTask();
+		GovTask(timerCount, BeatGetPeriod() / BEAT_TICKS_PER_T1);
 	}
-	
 }
 
+/* ------------------------------------------------------------ */
+
 int main(void)
 {
+	struct preset	pre;
+	char			szSong[24];
+	BOOL			fSong = fFalse;		//start from the stored song, no taps
+	BOOL			fResume;			//already clicking from the last state
+	WORD			periodStart;
+
 	//buttons, LEDs, timers, ISRs
 	DeviceInit();	
 
+	//the LCD takes tens of ms to come up, so a rescue or resume
+	// starts first
+	fResume = FRescue() || FResume();
+#if defined(BOOT_TIME)
+	//the core timer counts SYSCLK / 2 from reset, and the first beat
+	// is BOOT_LEAD_US after FResume() to the tick
+	if(fResume)
+		printf("boot: first beat %d us\n",
+			(int)( ReadCoreTimer() / ( SYS_FREQ / 2000000 ) ) + BOOT_LEAD_US);
+#endif
+	RescueKick();
+   	initLCD();	
+#if defined(BOOT_TIME)
+	printf("boot: LCD up %d us\n", (int)( ReadCoreTimer() / ( SYS_FREQ / 2000000 ) ));
+#endif
+
 	//too much time LCD display
-	clrLCD();
-	cmdLCD(0x00 | 0x00);
-	putsLCD("give 2 taps:");
-	cmdLCD(0x80 | 0x40);
-	putsLCD("btn2 then btn1");
+	if(!fResume)
+	{
+		clrLCD();
+		cmdLCD(0x00 | 0x00);
+		putsLCD("give 2 taps:");
+		cmdLCD(0x80 | 0x40);
+		putsLCD("btn2 then btn1");
+	}
 
-	while(1)
+	//or btn1 on its own picks up the song used last time
+	if(!fResume && PresetGetCurrent() != PRESET_NONE)
 	{
+		songSel = PresetGetCurrent();
+		PresetGet(songSel, &pre);
+		sprintf(szSong, "%-8s %3d BPM", pre.szName, (int)pre.bpm % 1000);
+		cmdLCD(0x80 | 0x00);
+		putsLCD("taps, or btn1:");
+		cmdLCD(0x80 | 0x40);
+		putsLCD(szSong);
+	}
+
+	//an external MIDI clock can take over while we wait for taps
+	if(!fResume)
+		MidiSetMode(MIDI_IN);
+
+	while(!fResume)
+	{
+		RescueKick();
+
+		if(MidiSlaveLocked() && MidiSlaveRunning())
+			RunSlave();
+
+		if(ButtonState()==1 && PresetGetCurrent() != PRESET_NONE)
+		{
+			//let go first, or the release would step the setlist
+			while(ButtonState() != 0)
+				RescueKick();
+			fSong = fTrue;
+			break;
+		}
+
 		// restart timerCount when btn2 pressed
 		// only 1, 2 or 3 (don't use 3)
-		if(ButtonPressed()==2)
+		if(ButtonState()==2)
 		{
 			//rising edge only
 			if(btn2Edge==fFalse)
@@ -597,9 +1384,13 @@ int main(void)
 	}
 
 	//now, get the click from button1
-	while(1)
+	while(!fSong && !fResume)
 	{
-		WORD buttonTemp = ButtonPressed();
+		//poll rather than block, so the watchdog and allowed_time are
+		// both looked at on every pass, not only once a button comes in
+		WORD buttonTemp = ButtonState();
+
+		RescueKick();
 
 		//while loop limit... user has exceeded allowed_time
 		if(timerCount >= allowedTime)
@@ -617,7 +1408,7 @@ int main(void)
 	}
 
 	//value has NOT been entered within allowed_time
-	if(tempo==0)
+	if(tempo==0 && !fSong && !fResume)
 	{
 		//too much time LCD display
 		clrLCD();
@@ -633,19 +1424,120 @@ int main(void)
 	}
 
 	//it has been entered within allowed_time!
-	char bpm[20] = "BPM = ";
-	float tempoFloat = (float)tempo;
-	int BPM = (60000.0f * 0.79f)/tempoFloat;	//our fudge factor stuff!
-	strcat(bpm, intToString(BPM));
+	//the beat engine is exact, so the BPM comes straight from its period
+	// and the old fudge factor is gone
 	clrLCD();
-	putsLCD(bpm);
+
+#if defined(ADPCM_BENCH)
+	//decode cost at full speed, shown on the second row until the governor redraws it
+	{
+		char bench[24];
+		WORD cyc = AudioBenchCycles();
+		sprintf(bench, "adpcm %d.%d cyc", (int)( cyc / 10 ), (int)( cyc % 10 ));
+		cmdLCD(0x80 | 0x40);
+		putsLCD(bench);
+	}
+#endif
+
+	//the beat engine blips, clicks and sends MIDI clock on its own from here on
+	if(!fResume)
+	{
+		AudioEnable(fTrue);
+		MidiSetMode(MIDI_OUT);
+		//with a count-in, ShowPosition() sends Start at bar 1
+		if(COUNT_IN_BARS == 0)
+			MidiStart();
+		periodStart = tempo * BEAT_TICKS_PER_T1;
+		if(fSong)
+		{
+			//the song's meter and feel are ready for the first bar line
+			RecallSong(songSel);
+			periodStart = BeatGetPeriodNext();
+		}
+		BeatStart(periodStart);
+		//in tap mode button 1 taps along to pull the click in
+		SetMode(fSong ? MODE_SET : MODE_TAP);
+	}
+	ShowTempo(fTrue);
+
+	//nothing left but housekeeping: slow the clocks down
+	PowerEnterRun();
+	//the presses that started us are no gesture
+	GestureClear();
+
+	WORD periodShown = BeatGetPeriod();
+#if defined(MIDI_JITTER)
+	WORD beatJitShown = 0;
+#endif
+#if defined(ONSET_STATS)
+	WORD barOnsetShown = 0;
+#endif
 
 	while(1)
 	{
-		timer1Wait(tempo);
-		SignalStatus(SIGNAL_BUTTON1);
-		timer1Wait(5);
-		SignalStatus(SIGNAL_RESET);
+		PowerIdle();
+
+		//a pass that never comes resets the part, and FRescue() picks up
+		WatchTask();
+
+		//cheap unless a new battery burst came in
+		SocTask();
+		//may shorten the blip, slow the clock or redraw the status field
+		GovTask(timerCount, BeatGetPeriod() / BEAT_TICKS_PER_T1);
+
+		//nudges and tap-along corrections show up in the tempo field,
+		// in the gap after the next beat like all LCD writes
+		NudgeTask();
+		SwitchTask();
+		ShowPosition();
+		if(( fTempoDirty || BeatGetPeriod() != periodShown ) && SchedIoWindow())
+		{
+			periodShown = BeatGetPeriod();
+			ShowTempo(fTempoDirty);
+			fTempoDirty = fFalse;
+		}
+
+		//saved songs and the state to resume with go to flash in the
+		// same window
+		ResumeTask();
+		// and a full page shows on the setlist row
+		{
+			BOOL	fFull = !PresetTask(timerCount);
+
+			if(fFull != fPresetFull)
+			{
+				fPresetFull = fFull;
+				fTempoDirty = fTrue;
+			}
+		}
+
+#if defined(MIDI_JITTER)
+		//worst clock write latency so far, over the meter field
+		if (( beatCount & 7 ) == 0 && beatCount != beatJitShown && SchedIoWindow()) {
+			char jit[8];
+			beatJitShown = beatCount;
+			sprintf(jit, "%3du", (int)MidiLatencyMaxUs());
+			cmdLCD(0x80 | 0x08);
+			putsLCD(jit);
+		}
+#endif
+
+#if defined(ONSET_STATS)
+		//worst click-onset delay with the I/O policy on and off, over the
+		// meter and mode fields; the policy swaps every 16 bars.  Only
+		// preset and resume flash writes can stall the clicks, so save a
+		// few while it runs or the two figures come out the same
+		if(( barCount & 15 ) == 0 && barCount != barOnsetShown && SchedIoWindow())
+		{
+			char onset[24];
+			barOnsetShown = barCount;
+			sprintf(onset, "%3d/%3du", (int)SchedOnsetMaxUs(fTrue) % 1000,
+				(int)SchedOnsetMaxUs(fFalse) % 1000);
+			cmdLCD(0x80 | 0x08);
+			putsLCD(onset);
+			SchedSetPolicy(!SchedGetPolicy());
+		}
+#endif
 	}
 	
     exit(0);
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-meter and subdivision engine.  Lays a bar out as a table     *
+ *				 of per-pulse events for the beat interrupt.                  *
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "config.h"
+#include "stdtypes.h"
+#include "audio.h"
+#include "beat.h"
+#include "meter.h"
+#include "led.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		EV_NONE				0
+#define		EV_DOWNBEAT			1
+#define		EV_GROUP			2			// first beat of a later group
+#define		EV_BEAT				3
+#define		EV_SUB				4
+#define		EV_CLASSES			5
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct meter {
+	BYTE	cbeat;
+	BYTE	fsGroup;		// bit n set: beat n starts a group
+	char	szName[4];
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static const struct meter rgmeter[METER_COUNT] = {
+	{ 2, 0x01, "2/4" },		// METER_2_4
+	{ 3, 0x01, "3/4" },		// METER_3_4
+	{ 4, 0x05, "4/4" },		// METER_4_4: lighter accent on 3
+	{ 6, 0x09, "6/8" },		// METER_6_8: 3+3
+	{ 7, 0x15, "7/8" },		// METER_7_8: 2+2+3
+};
+
+// pulses between subdivision clicks
+static const BYTE rgcpulseSub[SUB_COUNT] = {
+	0, BEAT_PPQN / 2, BEAT_PPQN / 3, BEAT_PPQN / 4 };
+
+// how each kind of event looks and sounds
+static const struct ev rgevClass[EV_CLASSES] = {
+	{ 0, EV_WAVE_NONE, 0 },											// EV_NONE
+	{ LED_ALL, AUDIO_ACCENT, 6 },									// EV_DOWNBEAT
+	{ LED_MASK(0x3), AUDIO_COWBELL, 5 },							// EV_GROUP
+	{ LED_MASK(0x1), AUDIO_CLICK, 4 },								// EV_BEAT
+	{ LED_MASK(0x8), AUDIO_WOODBLOCK, 2 },							// EV_SUB
+};
+
+static struct bar	rgbar[2];
+static WORD		meterCur = METER_4_4;
+static WORD		subCur = SUB_NONE;
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void MeterInit(void)
+{
+	MeterSet(METER_4_4, SUB_NONE);
+}
+
+//Withdrawing any pending table first means the beat engine can't
+// switch while this runs, so the table it isn't using is free to
+// rewrite, however quickly changes come.
+void MeterSet(WORD meter, WORD sub)
+{
+	struct bar	*pbar;
+	const struct meter	*pm;
+	WORD	ipulse;
+	WORD	beat;
+	WORD	off;
+	WORD	cls;
+
+	if (meter >= METER_COUNT)
+		meter = METER_4_4;
+	if (sub >= SUB_COUNT)
+		sub = SUB_NONE;
+
+	BeatSetBar(NULL);
+	pbar = ( BeatGetBar() == &rgbar[0] ) ? &rgbar[1] : &rgbar[0];
+
+	pm = &rgmeter[meter];
+	pbar->cbeat = pm->cbeat;
+	pbar->cpulse = pm->cbeat * BEAT_PPQN;
+
+	for (ipulse = 0; ipulse < pbar->cpulse; ipulse++) {
+		beat = ipulse / BEAT_PPQN;
+		off = ipulse % BEAT_PPQN;
+
+		if (off == 0)
+			cls = ( beat == 0 ) ? EV_DOWNBEAT :
+				( pm->fsGroup & ( 1 << beat ) ) ? EV_GROUP : EV_BEAT;
+		else if (rgcpulseSub[sub] != 0 && off % rgcpulseSub[sub] == 0)
+			cls = EV_SUB;
+		else
+			cls = EV_NONE;
+
+		pbar->rgev[ipulse] = rgevClass[cls];
+	}
+
+	BeatSetBar(pbar);
+	meterCur = meter;
+	subCur = sub;
+}
+
+WORD MeterGet(void)
+{
+	return meterCur;
+}
+
+WORD MeterGetSub(void)
+{
+	return subCur;
+}
+
+const char * MeterName(WORD meter)
+{
+	return ( meter < METER_COUNT ) ? rgmeter[meter].szName : "";
+}
@@ -0,0 +1,80 @@
+/************************************************************************/
+/*																		*/
+/*	meter.h -- Time signatures, accents and subdivisions				*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	A bar is laid out on the beat engine's 24 pulse per beat grid as	*/
+/*	a table with one entry per pulse, saying which LEDs light, which	*/
+/*	sound plays and how wide the blip is.  The table is built here		*/
+/*	whenever the meter or subdivision changes, and the beat interrupt	*/
+/*	just indexes it with the pulse number.  Two tables take turns so	*/
+/*	the one in use is never rewritten; the beat engine switches at		*/
+/*	the next bar line.													*/
+/*																		*/
+/*	The beat is the meter's counting unit: a quarter in x/4 and an		*/
+/*	eighth in x/8, so 6/8 at 120 BPM is 120 eighths a minute.			*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_METER_INC)
+#define _METER_INC
+
+#include "stdtypes.h"
+#include "beat.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	METER_2_4			0
+#define	METER_3_4			1
+#define	METER_4_4			2
+#define	METER_6_8			3			// 3+3
+#define	METER_7_8			4			// 2+2+3
+#define	METER_COUNT			5
+
+#define	SUB_NONE			0
+#define	SUB_EIGHTH			1			// 2 per beat
+#define	SUB_TRIPLET			2			// 3 per beat
+#define	SUB_SIXTEENTH		3			// 4 per beat
+#define	SUB_COUNT			4
+
+#define	METER_BEATS_MAX		7
+#define	BAR_PULSES_MAX		( METER_BEATS_MAX * BEAT_PPQN )
+
+#define	EV_WAVE_NONE		0xFF
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+struct ev {
+	HWORD	msk;			// LEDs to light, 0 = nothing on this pulse
+	BYTE	wave;			// AUDIO_xxx or EV_WAVE_NONE
+	BYTE	wscale;			// blip width in quarters of the base width
+};
+
+struct bar {
+	HWORD		cpulse;		// pulses in the bar
+	HWORD		cbeat;
+	struct ev	rgev[BAR_PULSES_MAX];
+};
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+//4/4, no subdivision
+void	MeterInit(void);
+//rebuilds the spare table and hands it to the beat engine
+void	MeterSet(WORD meter, WORD sub);
+WORD	MeterGet(void);
+WORD	MeterGetSub(void);
+//"7/8" and so on
+const char *	MeterName(WORD meter);
+
+/* ------------------------------------------------------------ */
+
+#endif
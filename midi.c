@@ -0,0 +1,333 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-MIDI clock output and input.  The beat engine's Timer2       *
+ *				 interrupt writes every clock byte out; in slave mode the RX  *
+ *				 interrupt timestamps incoming clocks and runs the PLL.       *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "power.h"
+#include "beat.h"
+#include "midi.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		bnON				15			// U1MODE
+#define		bnBRGH				3			// U1MODE: 4x baud clock
+#define		bnUTXEN				10			// U1STA
+#define		bnUTXBF				9			// U1STA: transmit buffer full
+#define		bnURXEN				12			// U1STA
+#define		bnURXDA				0			// U1STA: receive data available
+#define		mskUERR				( ( 1 << 3 ) | ( 1 << 2 ) | ( 1 << 1 ) )	// PERR FERR OERR
+#define		bnU1RX				27			// IFS0/IEC0
+#define		bnU1E				26
+
+// one MIDI byte is 10 bits at 31250 baud; the RX interrupt comes at
+// its stop bit, this long after the byte started
+#define		RX_BYTE_TICKS		( BEAT_TICK_HZ * 10 / MIDI_BAUD )
+
+// PLL gains: a critically damped second order loop with a bandwidth
+// of about a tenth of the clock rate
+#define		PLL_PHASE_DIV		8			// phase: 1/8 of the error
+#define		PLL_FREQ_SHIFT		1			// period: 1/128 of it, in Q8
+#define		PLL_LOCK_CLOCKS		BEAT_PPQN	// clean clocks before locking
+#define		PLL_BEAT_DIV		4			// local beat phase: 1/4 per beat
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static volatile WORD	midiMode = MIDI_OFF;
+static volatile BYTE	fStartPending = fFalse;
+static volatile BYTE	fStopPending = fFalse;
+
+static volatile HWORD	tckLatMin = 0xFFFF;		// TMR2 at the clock write
+static volatile HWORD	tckLatMax = 0;
+
+// slave PLL, only touched by the RX interrupt once running
+static WORD		cclkSeen = 0;			// clocks since the PLL (re)started
+static WORD		tckPrev = 0;			// first clock, for the first period
+static WORD		tckPred = 0;			// predicted time of the next clock
+static volatile WORD	tckPulseQ8 = 0;	// filtered clock period, Q8 ticks
+static WORD		clkIdx = 0;				// master pulse within its beat
+static WORD		cclkGood = 0;			// clocks in a row inside the lock window
+static volatile BYTE	fLocked = fFalse;
+static volatile BYTE	fMasterRun = fFalse;
+static volatile BYTE	fFollow = fFalse;	// steer the local beat engine
+static volatile WORD	cbeatMaster = 0;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+//a full FIFO only happens if the line is jammed; drop rather than wait
+static void MidiPut(BYTE b)
+{
+	if (( U1STA & ( 1 << bnUTXBF ) ) == 0)
+		U1TXREG = b;
+}
+
+static void PllReset(void)
+{
+	cclkSeen = 0;
+	cclkGood = 0;
+	fLocked = fFalse;
+}
+
+//Each master beat, pull the nearest local beat towards it a fraction
+// of the way and hand the beat engine the tracked period.
+static void PllSteer(WORD tckMaster)
+{
+	WORD	period = ( tckPulseQ8 * BEAT_PPQN ) >> 8;
+	int		dtck;
+
+	BeatSetPeriod(period);
+
+	dtck = (int)( tckMaster - BeatLastBeat() );
+	if (dtck > (int)( period / 2 ))
+		dtck -= period;
+	BeatShift(dtck / PLL_BEAT_DIV);
+}
+
+//Second order PLL on the clock timestamps: the phase error moves the
+// next prediction a little and the period a little less.  A missing
+// clock (a byte lost to noise or a baud change) is skipped over;
+// anything further out restarts the loop.
+static void PllClock(WORD tck)
+{
+	WORD	tckPulse = tckPulseQ8 >> 8;
+	WORD	tckFilt;
+	int		err;
+
+	if (cclkSeen == 0) {
+		tckPrev = tck;
+		cclkSeen = 1;
+		return;
+	}
+	if (cclkSeen == 1) {
+		tckPulseQ8 = ( tck - tckPrev ) << 8;
+		tckPred = tck + ( tck - tckPrev );
+		cclkSeen = 2;
+		if (++clkIdx == BEAT_PPQN)
+			clkIdx = 0;
+		return;
+	}
+
+	err = (int)( tck - tckPred );
+	while (err > (int)( tckPulse / 2 ) && err < (int)( 2 * tckPulse )) {
+		tckPred += tckPulse;
+		err -= tckPulse;
+		if (++clkIdx == BEAT_PPQN)
+			clkIdx = 0;
+	}
+	if (err > (int)( tckPulse / 2 ) || err < -(int)( tckPulse / 2 )) {
+		PllReset();
+		PllClock(tck);
+		return;
+	}
+
+	tckFilt = tckPred + err / PLL_PHASE_DIV;
+	tckPred = tckFilt + tckPulse;
+	tckPulseQ8 += err * ( 1 << PLL_FREQ_SHIFT );
+
+	if (err < (int)( tckPulse / 16 ) && err > -(int)( tckPulse / 16 )) {
+		if (cclkGood < PLL_LOCK_CLOCKS)
+			cclkGood++;
+		else
+			fLocked = fTrue;
+	}
+	else
+		cclkGood = 0;
+
+	if (++clkIdx == BEAT_PPQN)
+		clkIdx = 0;
+	if (clkIdx == 0 && fLocked) {
+		cbeatMaster++;
+		if (fFollow && fMasterRun)
+			PllSteer(tckFilt);
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Service Routines						*/
+/* ------------------------------------------------------------ */
+
+//Real-time bytes may turn up anywhere, even inside other messages,
+// and are acted on at once.  Everything else only matters as far as
+// not mistaking it for clock, so it is dropped.
+void __ISR(_UART_1_VECTOR, ipl5) MidiRxHandler(void)
+{
+	WORD	tck;
+	BYTE	b;
+
+	tck = BeatNow() - RX_BYTE_TICKS;
+
+	if (U1STA & mskUERR)
+		U1STACLR = mskUERR;
+	IFS0CLR = ( 1 << bnU1RX ) | ( 1 << bnU1E );
+
+	while (U1STA & ( 1 << bnURXDA )) {
+		b = U1RXREG;
+		switch (b) {
+		case MIDI_CLOCK:
+			PllClock(tck);
+			break;
+		case MIDI_START:
+			// the next clock is the first pulse of beat one
+			clkIdx = BEAT_PPQN - 1;
+			fMasterRun = fTrue;
+			break;
+		case MIDI_CONTINUE:
+			fMasterRun = fTrue;
+			break;
+		case MIDI_STOP:
+			fMasterRun = fFalse;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void MidiInit(void)
+{
+	U1MODE = ( 1 << bnBRGH );
+	U1STA = 0;
+	MidiSetPbClk(PowerGetPbClk());
+
+	// TX interrupt stays off: the beat ISR feeds the transmitter.
+	// RX and error interrupts at priority level 5, under the beat engine.
+	IEC0CLR = ( 1 << 28 ) | ( 1 << bnU1RX ) | ( 1 << bnU1E );
+	IPC6CLR = ( 7 << 2 ) | ( 3 << 0 );
+	IPC6SET = ( 5 << 2 );
+}
+
+void MidiSetMode(WORD mode)
+{
+	IEC0CLR = ( 1 << bnU1RX ) | ( 1 << bnU1E );
+	U1STACLR = ( 1 << bnUTXEN ) | ( 1 << bnURXEN );
+	U1MODECLR = ( 1 << bnON );
+	fStartPending = fStopPending = fFalse;
+	fFollow = fMasterRun = fFalse;
+	PllReset();
+
+#if defined(PMOD_BTN)
+	// the PmodBTN has JE3/JE4, RX and TX
+	mode = MIDI_OFF;
+#endif
+	midiMode = mode;
+
+	if (mode == MIDI_OUT) {
+		U1MODESET = ( 1 << bnON );
+		U1STASET = ( 1 << bnUTXEN );
+	}
+	else if (mode == MIDI_IN) {
+		U1MODESET = ( 1 << bnON );
+		U1STASET = ( 1 << bnURXEN );
+		IFS0CLR = ( 1 << bnU1RX ) | ( 1 << bnU1E );
+		IEC0SET = ( 1 << bnU1RX ) | ( 1 << bnU1E );
+	}
+}
+
+WORD MidiGetMode(void)
+{
+	return midiMode;
+}
+
+void MidiStart(void)
+{
+	fStopPending = fFalse;
+	fStartPending = fTrue;
+}
+
+void MidiStop(void)
+{
+	fStartPending = fFalse;
+	fStopPending = fTrue;
+}
+
+//Start goes out just ahead of the clock that begins its beat, so the
+// receiver counts that clock as beat one
+void MidiPulse(BOOL fBeat)
+{
+	HWORD	tck;
+
+	if (midiMode != MIDI_OUT)
+		return;
+
+	tck = TMR2;
+	if (fStopPending) {
+		MidiPut(MIDI_STOP);
+		fStopPending = fFalse;
+	}
+	else if (fBeat && fStartPending) {
+		MidiPut(MIDI_START);
+		fStartPending = fFalse;
+	}
+	MidiPut(MIDI_CLOCK);
+
+	if (tck < tckLatMin)
+		tckLatMin = tck;
+	if (tck > tckLatMax)
+		tckLatMax = tck;
+}
+
+//BRGH: PBCLK / 4 / 31250 is a whole number at every power level
+void MidiSetPbClk(WORD pbFreq)
+{
+	U1BRG = ( pbFreq / ( 4 * MIDI_BAUD ) ) - 1;
+}
+
+WORD MidiLatencyMinUs(void)
+{
+	return ( tckLatMin == 0xFFFF ) ? 0 : ( tckLatMin * 2 ) / 5;
+}
+
+WORD MidiLatencyMaxUs(void)
+{
+	return ( tckLatMax * 2 + 4 ) / 5;
+}
+
+void MidiLatencyReset(void)
+{
+	tckLatMin = 0xFFFF;
+	tckLatMax = 0;
+}
+
+BOOL MidiSlaveLocked(void)
+{
+	return fLocked;
+}
+
+BOOL MidiSlaveRunning(void)
+{
+	return fMasterRun;
+}
+
+WORD MidiSlaveBeats(void)
+{
+	return cbeatMaster;
+}
+
+WORD MidiSlavePeriod(void)
+{
+	return ( tckPulseQ8 * BEAT_PPQN ) >> 8;
+}
+
+//BPM x 10 = 60 * 2.5 MHz * 10 / 24 / pulse, with the pulse in Q4
+WORD MidiSlaveBpm10(void)
+{
+	WORD	pulseQ4 = tckPulseQ8 >> 4;
+
+	return pulseQ4 ? 1000000000L / pulseQ4 : 0;
+}
+
+void MidiSlaveFollow(BOOL fOn)
+{
+	fFollow = fOn;
+}
@@ -0,0 +1,82 @@
+/************************************************************************/
+/*																		*/
+/*	midi.h -- MIDI timing clock on UART1								*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	UART1 runs at the MIDI rate of 31250 baud, TX on RF8 (JE4).  In		*/
+/*	MIDI_OUT mode the beat engine calls MidiPulse() first thing in the	*/
+/*	Timer2 interrupt at each of the 24 pulses of a beat, so the 0xF8	*/
+/*	clock byte goes into the UART at a fixed point after the hardware	*/
+/*	timer match.  Start and Stop are queued and sent from the same		*/
+/*	interrupt at the next beat (Start) or pulse (Stop), so nothing		*/
+/*	else ever writes to the transmitter.								*/
+/*																		*/
+/*	In MIDI_IN mode UART1 receives on RF2 (JE3).  Each 0xF8 is			*/
+/*	timestamped on the beat engine's time base and fed to a software	*/
+/*	PLL that filters the master's clock jitter into a steady period		*/
+/*	and phase.  Once the main loop has started the beat engine on a		*/
+/*	master beat, the PLL steers it: the tracked period is applied at	*/
+/*	each beat and the local beat is pulled towards the master's.		*/
+/*																		*/
+/*	Clock jitter is the spread of the interrupt latency, which			*/
+/*	MidiPulse() measures as TMR2 at the moment of the write, plus up	*/
+/*	to one bit (32 us) while the UART lines the start bit up with its	*/
+/*	own bit clock.														*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_MIDI_INC)
+#define _MIDI_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	MIDI_OFF			0
+#define	MIDI_OUT			1			// send clock from the beat engine
+#define	MIDI_IN				2			// follow an external clock
+
+#define	MIDI_CLOCK			0xF8
+#define	MIDI_START			0xFA
+#define	MIDI_CONTINUE		0xFB
+#define	MIDI_STOP			0xFC
+
+#define	MIDI_BAUD			31250L
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	MidiInit(void);
+void	MidiSetMode(WORD mode);
+WORD	MidiGetMode(void);
+//queue Start for the next beat / Stop for the next pulse
+void	MidiStart(void);
+void	MidiStop(void);
+//beat engine, Timer2 ISR: one MIDI clock pulse; beat = first pulse of a beat
+void	MidiPulse(BOOL fBeat);
+//re-derive the baud rate after a PBCLK change; interrupts are off
+void	MidiSetPbClk(WORD pbFreq);
+//clock write latency after the timer match since the last reset, in us
+WORD	MidiLatencyMinUs(void);
+WORD	MidiLatencyMaxUs(void);
+void	MidiLatencyReset(void);
+
+//slave mode
+BOOL	MidiSlaveLocked(void);
+//the master is playing: Start or Continue seen, no Stop since
+BOOL	MidiSlaveRunning(void);
+//counts up at every master beat once locked
+WORD	MidiSlaveBeats(void);
+WORD	MidiSlavePeriod(void);
+WORD	MidiSlaveBpm10(void);
+//let the PLL steer the running beat engine
+void	MidiSlaveFollow(BOOL fOn);
+
+/* ------------------------------------------------------------ */
+
+#endif
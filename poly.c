@@ -0,0 +1,309 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-polyrhythm voices.  A min-heap of hit and LED-off times      *
+ *				 driven by OC5 compares on the beat engine's Timer2.          *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "config.h"
+#include "stdtypes.h"
+#include "audio.h"
+#include "beat.h"
+#include "poly.h"
+#include "sched.h"
+#include "led.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		bnON				15
+#define		OCM_TOGGLE			3			// compare toggles the pin
+#define		OCM_MASK			7
+#define		bnOC5				22			// IFS0/IEC0
+#define		cpevMax				( 2 * POLY_VOICES )	// a hit and an LED-off each
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct voice {
+	WORD	base;			// time of this bar's first hit
+	WORD	span;			// bar length in ticks
+	HWORD	n;				// hits per bar, 0 = silent
+	HWORD	k;				// next hit in this bar
+	HWORD	nNext;			// n from the next bar line
+};
+
+struct pev {
+	WORD	tck;
+	BYTE	voice;
+	BYTE	fOff;			// LED-off rather than a hit
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static const HWORD rgmskVoice[POLY_VOICES] = {
+	LED_MASK(0x1), LED_MASK(0x2), LED_MASK(0x4), LED_MASK(0x8) };
+static const BYTE rgwaveVoice[POLY_VOICES] = {
+	AUDIO_CLICK, AUDIO_WOODBLOCK, AUDIO_COWBELL, AUDIO_ACCENT };
+
+static struct voice	rgvoice[POLY_VOICES];
+static struct pev	rgpev[cpevMax];		// min-heap on tck
+static WORD		cpev = 0;
+static WORD		tckSegCur = 0;
+static WORD		lenSegCur = 0;
+static WORD		tckWidth = 0;
+static WORD		tckSound = 0;			// last hit that made a sound
+static BOOL		fPoly = fFalse;			// voices own the LEDs
+static volatile BOOL	fPolyReq = fFalse;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+//by time, wrapping; at the same time LED-offs go first, then voices
+// in order, so voice 0 makes the sound on a shared hit
+static BOOL FEarlier(const struct pev *pa, const struct pev *pb)
+{
+	int		dtck = (int)( pa->tck - pb->tck );
+
+	if (dtck != 0)
+		return dtck < 0;
+	if (pa->fOff != pb->fOff)
+		return pa->fOff;
+	return pa->voice < pb->voice;
+}
+
+static void HeapPush(WORD tck, WORD voice, BOOL fOff)
+{
+	struct pev	pev;
+	WORD	i;
+	WORD	iup;
+
+	// only if the blip outlasts the gap between a voice's hits
+	if (cpev == cpevMax)
+		return;
+	i = cpev++;
+
+	pev.tck = tck;
+	pev.voice = voice;
+	pev.fOff = fOff;
+
+	while (i > 0) {
+		iup = ( i - 1 ) / 2;
+		if (!FEarlier(&pev, &rgpev[iup]))
+			break;
+		rgpev[i] = rgpev[iup];
+		i = iup;
+	}
+	rgpev[i] = pev;
+}
+
+static struct pev HeapPop(void)
+{
+	struct pev	pevTop = rgpev[0];
+	struct pev	pevLast = rgpev[--cpev];
+	WORD	i = 0;
+	WORD	ich;
+
+	while (( ich = 2 * i + 1 ) < cpev) {
+		if (ich + 1 < cpev && FEarlier(&rgpev[ich + 1], &rgpev[ich]))
+			ich++;
+		if (!FEarlier(&rgpev[ich], &pevLast))
+			break;
+		rgpev[i] = rgpev[ich];
+		i = ich;
+	}
+	if (cpev > 0)
+		rgpev[i] = pevLast;
+
+	return pevTop;
+}
+
+//from the bar start every time: nothing accumulates
+static WORD HitTime(const struct voice *pv, WORD k)
+{
+	return pv->base + ( pv->span * k ) / pv->n;
+}
+
+static void Fire(const struct pev *ppev)
+{
+	struct voice	*pv = &rgvoice[ppev->voice];
+
+	if (ppev->fOff) {
+		latLedClr = rgmskVoice[ppev->voice];
+		return;
+	}
+
+	latLedSet = rgmskVoice[ppev->voice];
+	if (ppev->tck != tckSound) {
+		AudioPlay(rgwaveVoice[ppev->voice]);
+		SchedClickOnset(BeatNow() - ppev->tck);
+		tckSound = ppev->tck;
+	}
+	HeapPush(ppev->tck + tckWidth, ppev->voice, fTrue);
+
+	// the next bar's first hit comes from PolyBar()
+	if (++pv->k < pv->n)
+		HeapPush(HitTime(pv, pv->k), ppev->voice, fFalse);
+}
+
+//Fire everything due, then point OC5 at the earliest event if it is
+// inside this segment; otherwise the next segment start looks again.
+// Events can come due while this runs, hence the loop.
+static void Service(void)
+{
+	struct pev	pev;
+	WORD	tckNow;
+	WORD	off;
+
+	while (1) {
+		tckNow = tckSegCur + TMR2;
+		while (cpev > 0 && (int)( rgpev[0].tck - tckNow ) <= 0) {
+			pev = HeapPop();
+			Fire(&pev);
+		}
+
+		if (cpev == 0 || ( off = rgpev[0].tck - tckSegCur ) >= lenSegCur) {
+			IEC0CLR = ( 1 << bnOC5 );
+			return;
+		}
+
+		OC5R = off;
+		IFS0CLR = ( 1 << bnOC5 );
+		IEC0SET = ( 1 << bnOC5 );
+		if (TMR2 < off)
+			return;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Service Routines						*/
+/* ------------------------------------------------------------ */
+
+//same priority as the beat engine, so the two never interleave
+void __ISR(_OUTPUT_COMPARE_5_VECTOR, ipl6) PolyHandler(void)
+{
+	mOC5ClearIntFlag();
+
+	if (fPoly)
+		Service();
+	else
+		IEC0CLR = ( 1 << bnOC5 );
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+//only events inside the current segment are armed on OC5; later ones
+// wait for a segment start, which BeatTicksToNext() covers
+WORD PolyTicksToNext(void)
+{
+	unsigned int intStat;
+	WORD	tck = 0xFFFFFFFF;
+
+	intStat = INTDisableInterrupts();
+	if (IEC0 & ( 1 << bnOC5 ))
+		tck = ( ( IFS0 & ( 1 << bnOC5 ) ) || TMR2 >= OC5R ) ? 0 : OC5R - TMR2;
+	INTRestoreInterrupts(intStat);
+
+	return tck;
+}
+
+void PolyInit(void)
+{
+	WORD	voice;
+
+	for (voice = 0; voice < POLY_VOICES; voice++)
+		rgvoice[voice].n = rgvoice[voice].nNext = 0;
+	cpev = 0;
+	fPoly = fPolyReq = fFalse;
+
+	// OC5 on Timer2, toggling; interrupt at priority level 6
+	OC5CON = OCM_TOGGLE;
+	OC5R = 0;
+	IPC5CLR = ( 7 << 18 ) | ( 3 << 16 );
+	IPC5SET = ( 6 << 18 );
+	IFS0CLR = ( 1 << bnOC5 );
+	OC5CONSET = ( 1 << bnON );
+}
+
+//takes effect at the next bar line
+void PolySetVoice(WORD voice, WORD n)
+{
+	if (voice >= POLY_VOICES)
+		return;
+	if (n > POLY_HITS_MAX)
+		n = POLY_HITS_MAX;
+	rgvoice[voice].nNext = n;
+}
+
+void PolyEnable(BOOL fOn)
+{
+	fPolyReq = fOn;
+}
+
+BOOL PolyEnabled(void)
+{
+	return fPolyReq;
+}
+
+//Hands the LEDs over at the bar line.  Hits left over from the last
+// bar (a tempo change can stretch it) are dropped; LED-offs are kept.
+void PolyBar(WORD tckBar, WORD tckBarLen, WORD tckWidthBar)
+{
+	struct pev	rgpevOff[cpevMax];
+	WORD	cpevOff = 0;
+	WORD	voice;
+	WORD	i;
+
+	if (fPoly != fPolyReq) {
+		fPoly = fPolyReq;
+		BeatSetEvents(!fPoly);
+		latLedClr = LED_ALL;
+		cpev = 0;
+	}
+	if (!fPoly)
+		return;
+
+	for (i = 0; i < cpev; i++)
+		if (rgpev[i].fOff)
+			rgpevOff[cpevOff++] = rgpev[i];
+	cpev = 0;
+	for (i = 0; i < cpevOff; i++)
+		HeapPush(rgpevOff[i].tck, rgpevOff[i].voice, fTrue);
+
+	tckWidth = tckWidthBar;
+	for (voice = 0; voice < POLY_VOICES; voice++) {
+		struct voice	*pv = &rgvoice[voice];
+
+		pv->n = pv->nNext;
+		if (pv->n == 0)
+			continue;
+		pv->base = tckBar;
+		pv->span = tckBarLen;
+		pv->k = 0;
+		HeapPush(tckBar, voice, fFalse);
+	}
+}
+
+void PolySegment(WORD tckSeg, WORD len)
+{
+	tckSegCur = tckSeg;
+	lenSegCur = len;
+
+	if (fPoly)
+		Service();
+}
+
+//beat stopped: drop everything and hand the LEDs back
+void PolyHalt(void)
+{
+	IEC0CLR = ( 1 << bnOC5 );
+	cpev = 0;
+	if (fPoly) {
+		fPoly = fFalse;
+		BeatSetEvents(fTrue);
+	}
+}
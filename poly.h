@@ -0,0 +1,56 @@
+/************************************************************************/
+/*																		*/
+/*	poly.h -- Polyrhythm voices											*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Up to four voices, one per LED, each firing n times per bar of		*/
+/*	the running meter, e.g. 3 against 4 or 5 against 4.  Voice v's		*/
+/*	k-th hit is at bar start + k * bar / n, worked out from the bar		*/
+/*	start every time, so no rounding ever builds up and the voices		*/
+/*	line up again exactly on each downbeat.								*/
+/*																		*/
+/*	All voices run off the beat engine's Timer2: pending hits and		*/
+/*	LED-off times sit in a min-heap by time, and output compare 5		*/
+/*	(on Timer2) interrupts at the earliest one that falls inside the	*/
+/*	current Timer2 segment.  The OC5 pin (RD4) toggles at each event,	*/
+/*	which makes a handy scope strobe.									*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_POLY_INC)
+#define _POLY_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	POLY_VOICES			4
+#define	POLY_HITS_MAX		16			// per bar
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	PolyInit(void);
+//n hits a bar on voice (LEDv+1); 0 silences the voice
+void	PolySetVoice(WORD voice, WORD n);
+//takes over the LEDs and sound from the next bar line; off hands them back
+void	PolyEnable(BOOL fOn);
+BOOL	PolyEnabled(void);
+
+//beat engine, Timer2 ISR: a bar starts now / a new segment has started
+void	PolyBar(WORD tckBar, WORD tckBarLen, WORD tckWidth);
+void	PolySegment(WORD tckSeg, WORD len);
+//BeatStop(): drop pending events
+void	PolyHalt(void);
+//beat ticks until the OC5 interrupt for the next event, or ~0 if none
+// is armed in this segment
+WORD	PolyTicksToNext(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
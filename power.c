@@ -0,0 +1,180 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-runtime power manager.  The config pragmas fix the boot      *
+ *				 clocks; this drops SYSCLK/PBCLK once the metronome is        *
+ *				 running and rescales the timers so ticks don't move.         *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "LCD.h"
+#include "midi.h"
+#include "power.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		SYSKEY_1			0xAA996655	// system unlock sequence
+#define		SYSKEY_2			0x556699AA
+#define		bnTCKPS				4			// TxCON prescaler field
+#define		mskT1CKPS			( 3 << bnTCKPS )
+#define		mskT5CKPS			( 7 << bnTCKPS )
+#define		mskT2CKPS			( 7 << bnTCKPS )
+#define		mskT4CKPS			( 7 << bnTCKPS )
+#define		bnON				15			// ON bit of OCxCON
+#define		bnTON				15			// ON bit of TxCON
+#define		mskTON				( 1 << bnTON )
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct pwrlvl {
+	BYTE	pllodiv;	// OSCCON.PLLODIV code (80 MHz PLL output / 2^n)
+	BYTE	pbdiv;		// OSCCON.PBDIV code (SYSCLK / 2^n)
+	BYTE	t1ckps;		// Timer1 prescaler code
+	BYTE	t5ckps;		// Timer5 prescaler code
+	BYTE	t2ckps;		// Timer2/Timer4 prescaler code for a 2.5 MHz tick
+	HWORD	pr1;		// Timer1 period for a 1.024 ms tick
+	HWORD	pr5;		// Timer5 period for an 80 us debounce tick
+	WORD	sysFreq;
+};
+
+// All levels give identical timer tick lengths:
+//	FULL: 10 MHz  / 256 * 40 = 1.024 ms, 10 MHz  / 8 * 100 = 80 us, 10 MHz  / 4
+//	RUN :  5 MHz  /  64 * 80 = 1.024 ms,  5 MHz  / 4 * 100 = 80 us,  5 MHz  / 2
+//	LOW :  5 MHz  /  64 * 80 = 1.024 ms,  5 MHz  / 4 * 100 = 80 us,  5 MHz  / 2
+// The beat timer (Timer2) and the audio sample clock (Timer4) only
+// change prescaler, so their counts and periods are left alone.
+// FULL is the boot clock of the config pragmas (mainMetronome2.c):
+// 8 MHz crystal / 2 * 20 = 80 MHz, PBCLK / 8.
+// LOW only slows the core: PBCLK stays at 5 MHz so the audio PWM
+// carrier (PBCLK / 256) stays above hearing.
+static const struct pwrlvl rgpwrlvl[PWR_LEVELS] = {
+	{ 0, 3, 3, 3, 2, 39, 99, 80000000L },	// PWR_FULL
+	{ 3, 1, 2, 2, 1, 79, 99, 10000000L },	// PWR_RUN
+	{ 4, 0, 2, 2, 1, 79, 99,  5000000L },	// PWR_LOW
+};
+
+static WORD pwrLevel = PWR_FULL;
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+WORD PowerGetLevel(void)
+{
+	return pwrLevel;
+}
+
+WORD PowerGetSysClk(void)
+{
+	return rgpwrlvl[pwrLevel].sysFreq;
+}
+
+WORD PowerGetPbClk(void)
+{
+	return rgpwrlvl[pwrLevel].sysFreq >> rgpwrlvl[pwrLevel].pbdiv;
+}
+
+WORD PowerGetBeatCkps(void)
+{
+	return rgpwrlvl[pwrLevel].t2ckps;
+}
+
+//switch PLL output and PB dividers, then rescale timers so their
+// tick length is unchanged.  TMR1 is scaled along with PR1 so the
+// tick in progress keeps its phase.  The timers are stopped from
+// before the bus clock changes until their new prescalers are in, so
+// none counts at the new clock with the old prescaler; each loses the
+// few bus cycles of the switch instead.
+WORD PowerSetLevel(WORD level)
+{
+	const struct pwrlvl *pnew;
+	const struct pwrlvl *pold;
+	WORD	levelPrev = pwrLevel;
+	unsigned int intStat;
+	WORD	t1on, t5on, t2on, t4on;
+
+	if (level >= PWR_LEVELS || level == pwrLevel)
+		return levelPrev;
+
+	pold = &rgpwrlvl[pwrLevel];
+	pnew = &rgpwrlvl[level];
+
+	// speeding up: raise flash wait states before the clock goes up
+	if (pnew->sysFreq > pold->sysFreq)
+		SYSTEMConfig(pnew->sysFreq, SYS_CFG_WAIT_STATES);
+
+	intStat = INTDisableInterrupts();
+
+	// Timer4 only runs while a sound plays; each restarts as it was
+	t1on = T1CON & mskTON;
+	t5on = T5CON & mskTON;
+	t2on = T2CON & mskTON;
+	t4on = T4CON & mskTON;
+	T1CONCLR = mskTON;
+	T5CONCLR = mskTON;
+	T2CONCLR = mskTON;
+	T4CONCLR = mskTON;
+
+	SYSKEY = 0;
+	SYSKEY = SYSKEY_1;
+	SYSKEY = SYSKEY_2;
+	OSCCONbits.PLLODIV = pnew->pllodiv;
+	OSCCONbits.PBDIV = pnew->pbdiv;
+	SYSKEY = 0;
+
+	TMR1 = ( TMR1 * ( pnew->pr1 + 1 ) ) / ( pold->pr1 + 1 );
+	PR1 = pnew->pr1;
+	T1CON = ( T1CON & ~mskT1CKPS ) | ( pnew->t1ckps << bnTCKPS );
+
+	TMR5 = ( TMR5 * ( pnew->pr5 + 1 ) ) / ( pold->pr5 + 1 );
+	PR5 = pnew->pr5;
+	T5CON = ( T5CON & ~mskT5CKPS ) | ( pnew->t5ckps << bnTCKPS );
+
+	T2CON = ( T2CON & ~mskT2CKPS ) | ( pnew->t2ckps << bnTCKPS );
+	T4CON = ( T4CON & ~mskT4CKPS ) | ( pnew->t2ckps << bnTCKPS );
+
+	T2CONSET = t2on;
+	T4CONSET = t4on;
+	T1CONSET = t1on;
+	T5CONSET = t5on;
+
+	// a byte on the wire right now is lost; the governor rarely switches
+	MidiSetPbClk(pnew->sysFreq >> pnew->pbdiv);
+
+	pwrLevel = level;
+	INTRestoreInterrupts(intStat);
+
+	// slowing down: fewer wait states are enough afterwards
+	if (pnew->sysFreq < pold->sysFreq)
+		SYSTEMConfig(pnew->sysFreq, SYS_CFG_WAIT_STATES);
+
+	return levelPrev;
+}
+
+//steady running: only Timer1/Timer5, the beat and audio timers, OC1,
+// OC4 and DMA are needed.
+// The ADC already powers itself down between battery bursts.
+void PowerEnterRun(void)
+{
+	// motor output compares are never used by the metronome
+	OC2CONCLR = ( 1 << bnON );
+	OC3CONCLR = ( 1 << bnON );
+
+	// PMP is re-enabled by the next LCD access
+	idleLCD();
+
+	PowerSetLevel(PWR_RUN);
+}
+
+void PowerEnterFull(void)
+{
+	PowerSetLevel(PWR_FULL);
+}
+
+//WAIT puts the core in idle; the next timer interrupt wakes it
+void PowerIdle(void)
+{
+	asm volatile("wait");
+}
@@ -0,0 +1,53 @@
+/************************************************************************/
+/*																		*/
+/*	power.h -- Runtime clock scaling and peripheral power-down			*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	The configuration pragmas boot the part at SYSCLK = 80 MHz and		*/
+/*	PBCLK = 10 MHz.  Once the metronome is only blipping LEDs it needs	*/
+/*	far less than that, so this module switches between power levels	*/
+/*	at runtime.  Each level reprograms the PLL output divider, the		*/
+/*	peripheral bus divider and the prescalers/periods of the timers		*/
+/*	so that every timer keeps exactly the same tick length.				*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_POWER_INC)
+#define _POWER_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	PWR_FULL			0		// 80 MHz SYSCLK, 10 MHz PBCLK (boot setting)
+#define	PWR_RUN				1		// 10 MHz SYSCLK, 5 MHz PBCLK (steady running)
+#define	PWR_LOW				2		// 5 MHz SYSCLK, 5 MHz PBCLK (battery saver)
+#define	PWR_LEVELS			3
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+//switch clocks and rescale timers; returns the previous level
+WORD	PowerSetLevel(WORD level);
+WORD	PowerGetLevel(void);
+WORD	PowerGetSysClk(void);
+WORD	PowerGetPbClk(void);
+//Timer2/Timer4 prescaler code giving a 2.5 MHz tick at this level
+WORD	PowerGetBeatCkps(void);
+
+//steady "running" state: slow clocks and turn off unused modules
+void	PowerEnterRun(void);
+//back to full speed for interactive work
+void	PowerEnterFull(void);
+
+//idle the CPU until the next interrupt
+void	PowerIdle(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
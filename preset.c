@@ -0,0 +1,363 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-setlist presets in two reserved program flash pages,         *
+ *				 written as append-only records.                              *
+ ******************************************************************************/
+
+#include <plib.h>
+#include <stdio.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "sched.h"
+#include "beat.h"
+#include "preset.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		NVM_PAGE			4096		// PIC32MX4 flash erase page, bytes
+#define		cwPage				( NVM_PAGE / 4 )
+#define		cwRec				4
+#define		crecPage			( cwPage / cwRec )	// record 0 is the header
+#define		crecLow				64			// swap pages at boot below this many free
+#define		PAGE_MAGIC			0x4C544553	// "SETL"
+#define		REC_SONG			0x5E
+#define		REC_CUR				0x5C
+#define		REC_RESUME			0x5D		// song field holds the mode
+#define		wErased				0xFFFFFFFF
+#define		BPM_DEFAULT			120
+#define		WRITE_US			200			// a record: 4 word writes, 40 us worst each
+#define		CUR_SETTLE_MS		2000		// a song stays selected this long before it is written
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+
+//The two pages.  Aligned and a page each, so nothing else shares them;
+// programming the part leaves them erased.  Always read through a
+// volatile pointer, since the compiler takes them for constants.
+static const WORD rgwStore[2][cwPage] __attribute__((aligned(NVM_PAGE))) = {
+	{ [0 ... cwPage - 1] = wErased },
+	{ [0 ... cwPage - 1] = wErased } };
+
+static const volatile WORD	*pwPage = NULL;			// active page
+static WORD		ipage = 0;
+static WORD		irecNext = 1;						// first free record
+static const volatile WORD	*rgpwSong[PRESET_SONGS];	// newest record, or NULL
+static WORD		songCur = PRESET_NONE;
+static WORD		songCurStored = PRESET_NONE;
+static WORD		songCurSeen = PRESET_NONE;		// as PresetTask() last saw it
+static WORD		tmsCurSeen = 0;
+static struct preset	rgpreStage[PRESET_SONGS];	// saves not written yet
+static WORD		fsStage = 0;
+static const volatile WORD	*pwResume = NULL;	// newest resume record, or NULL
+static struct preset	preResume;				// resume state not written yet
+static WORD		modeResume;
+static BOOL		fResumeStage = fFalse;
+static BOOL		fFull = fFalse;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static const volatile WORD * PwRec(WORD ipg, WORD irec)
+{
+	return (const volatile WORD *)&rgwStore[ipg][irec * cwRec];
+}
+
+static WORD Check(WORD w0, WORD w1, WORD w2, WORD w3)
+{
+	WORD	c = w0 ^ ( w0 >> 16 ) ^ ( w1 & 0xFFFF ) ^ w2 ^ ( w2 >> 16 ) ^ w3 ^ ( w3 >> 16 );
+
+	return ( c ^ 0xA55A ) & 0xFFFF;
+}
+
+static BOOL FPageValid(WORD ipg)
+{
+	const volatile WORD	*pw = PwRec(ipg, 0);
+
+	return pw[0] == PAGE_MAGIC && pw[2] == ~pw[1];
+}
+
+static void Encode(WORD tag, WORD song, const struct preset *ppre, WORD *rgw)
+{
+	WORD	ich;
+
+	rgw[0] = ( tag << 24 ) | ( song << 16 );
+	rgw[1] = 0;
+	rgw[2] = 0;
+	rgw[3] = 0;
+	if (ppre != NULL) {
+		rgw[0] |= ppre->bpm;
+		rgw[1] = ppre->meter | ( ppre->feel << 8 );
+		for (ich = 0; ich < PRESET_NAME && ppre->szName[ich] != '\0'; ich++)
+			rgw[2 + ich / 4] |= (WORD)(BYTE)ppre->szName[ich] << ( 8 * ( ich % 4 ) );
+	}
+	rgw[1] |= Check(rgw[0], rgw[1], rgw[2], rgw[3]) << 16;
+}
+
+static void Decode(const volatile WORD *pw, struct preset *ppre)
+{
+	WORD	ich;
+
+	ppre->bpm = pw[0] & 0xFFFF;
+	ppre->meter = pw[1] & 0xFF;
+	ppre->feel = ( pw[1] >> 8 ) & 0xFF;
+	for (ich = 0; ich < PRESET_NAME; ich++)
+		ppre->szName[ich] = ( pw[2 + ich / 4] >> ( 8 * ( ich % 4 ) ) ) & 0xFF;
+	ppre->szName[PRESET_NAME] = '\0';
+}
+
+//the first word goes last: a record only counts once it is there
+static BOOL WriteRec(const volatile WORD *pw, const WORD *rgw)
+{
+	WORD	iw;
+	BOOL	fOk = fTrue;
+
+	for (iw = 1; iw <= cwRec; iw++)
+		if (NVMWriteWord((void *)&pw[iw % cwRec], rgw[iw % cwRec]) != 0)
+			fOk = fFalse;
+	return fOk;
+}
+
+//newest record of each song, the current song and the first free record
+static void Scan(WORD ipg)
+{
+	const volatile WORD	*pw;
+	WORD	irec;
+	WORD	song;
+
+	ipage = ipg;
+	pwPage = PwRec(ipg, 0);
+	for (song = 0; song < PRESET_SONGS; song++)
+		rgpwSong[song] = NULL;
+	songCur = songCurStored = songCurSeen = PRESET_NONE;
+	pwResume = NULL;
+
+	for (irec = 1; irec < crecPage; irec++) {
+		pw = PwRec(ipg, irec);
+		if (pw[0] == wErased && pw[1] == wErased && pw[2] == wErased && pw[3] == wErased)
+			break;
+		// a write cut short before its first word
+		if (pw[0] == wErased || ( pw[1] >> 16 ) != Check(pw[0], pw[1], pw[2], pw[3]))
+			continue;
+
+		song = ( pw[0] >> 16 ) & 0xFF;
+		if (( pw[0] >> 24 ) == REC_RESUME)
+			pwResume = pw;
+		else if (song >= PRESET_SONGS)
+			continue;
+		else if (( pw[0] >> 24 ) == REC_SONG)
+			rgpwSong[song] = pw;
+		else if (( pw[0] >> 24 ) == REC_CUR)
+			songCur = songCurStored = songCurSeen = song;
+	}
+	irecNext = irec;
+	fFull = ( irecNext >= crecPage );
+}
+
+static void WriteHeader(WORD ipg, WORD gen)
+{
+	WORD	rgw[cwRec];
+
+	rgw[0] = PAGE_MAGIC;
+	rgw[1] = gen;
+	rgw[2] = ~gen;
+	rgw[3] = 0;
+	WriteRec(PwRec(ipg, 0), rgw);
+}
+
+//Live records to the other page, then its header; until the header
+// is written the old page stays the valid one.  The erase stalls the
+// CPU for tens of ms, so this is only done with the beat stopped.
+static void SwapPages(void)
+{
+	WORD	ipgNew = ipage ^ 1;
+	WORD	irec = 1;
+	WORD	song;
+	WORD	songSel = songCur;
+	WORD	songSeen = songCurSeen;
+	WORD	rgw[cwRec];
+	struct preset	pre;
+
+	NVMErasePage((void *)PwRec(ipgNew, 0));
+
+	for (song = 0; song < PRESET_SONGS; song++) {
+		if (rgpwSong[song] == NULL)
+			continue;
+		Decode(rgpwSong[song], &pre);
+		Encode(REC_SONG, song, &pre, rgw);
+		WriteRec(PwRec(ipgNew, irec++), rgw);
+	}
+	if (songCurStored != PRESET_NONE) {
+		Encode(REC_CUR, songCurStored, NULL, rgw);
+		WriteRec(PwRec(ipgNew, irec++), rgw);
+	}
+	if (pwResume != NULL) {
+		Decode(pwResume, &pre);
+		Encode(REC_RESUME, ( pwResume[0] >> 16 ) & 0xFF, &pre, rgw);
+		WriteRec(PwRec(ipgNew, irec++), rgw);
+	}
+
+	WriteHeader(ipgNew, pwPage[1] + 1);
+	Scan(ipgNew);
+
+	// a selection not written yet is still pending
+	songCur = songSel;
+	songCurSeen = songSeen;
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void PresetInit(void)
+{
+	BOOL	fValid0 = FPageValid(0);
+	BOOL	fValid1 = FPageValid(1);
+
+	fsStage = 0;
+	fResumeStage = fFalse;
+
+	if (!fValid0 && !fValid1) {
+		// first power-up, or both pages damaged
+		NVMErasePage((void *)PwRec(0, 0));
+		WriteHeader(0, 1);
+		Scan(0);
+		return;
+	}
+
+	if (fValid0 && fValid1)
+		Scan(( (int)( PwRec(1, 0)[1] - PwRec(0, 0)[1] ) > 0 ) ? 1 : 0);
+	else
+		Scan(fValid1 ? 1 : 0);
+
+	if (crecPage - irecNext < crecLow)
+		SwapPages();
+}
+
+BOOL PresetGet(WORD song, struct preset *ppre)
+{
+	if (song >= PRESET_SONGS)
+		song = 0;
+
+	if (fsStage & ( 1 << song )) {
+		*ppre = rgpreStage[song];
+		return fTrue;
+	}
+	if (rgpwSong[song] != NULL) {
+		Decode(rgpwSong[song], ppre);
+		return fTrue;
+	}
+
+	sprintf(ppre->szName, "Song %2d", (int)( song + 1 ) % 100);
+	ppre->bpm = BPM_DEFAULT;
+	ppre->meter = 0;
+	ppre->feel = 0;
+	return fFalse;
+}
+
+void PresetSave(WORD song, const struct preset *ppre)
+{
+	if (song >= PRESET_SONGS)
+		return;
+	rgpreStage[song] = *ppre;
+	fsStage |= ( 1 << song );
+}
+
+void PresetSetCurrent(WORD song)
+{
+	if (song < PRESET_SONGS)
+		songCur = song;
+}
+
+WORD PresetGetCurrent(void)
+{
+	return songCur;
+}
+
+//One record per call, a few word writes with the CPU stalled, so only
+// in the I/O window and with no beat engine interrupt due before they
+// are done.  A full page is compacted once the beat is stopped, since
+// the erase stalls the CPU for tens of ms; until then saves stay
+// staged.
+BOOL PresetTask(WORD tmsNow)
+{
+	WORD	rgw[cwRec];
+	WORD	song;
+	const volatile WORD	*pw;
+	BOOL	fCurDue;
+
+	// stepping through the setlist writes only where it stops
+	if (songCur != songCurSeen) {
+		songCurSeen = songCur;
+		tmsCurSeen = tmsNow;
+	}
+	fCurDue = ( songCur != songCurStored && tmsNow - tmsCurSeen >= CUR_SETTLE_MS );
+
+	if (fsStage == 0 && !fCurDue && !fResumeStage)
+		return !fFull;
+	if (fFull && !BeatRunning())
+		SwapPages();
+	if (fFull || !SchedIoWindow() || !SchedQuiet(WRITE_US))
+		return !fFull;
+
+	pw = PwRec(ipage, irecNext++);
+	fFull = ( irecNext >= crecPage );
+
+	if (fsStage != 0) {
+		for (song = 0; !( fsStage & ( 1 << song ) ); song++)
+			;
+		Encode(REC_SONG, song, &rgpreStage[song], rgw);
+		if (WriteRec(pw, rgw))
+			rgpwSong[song] = pw;
+		fsStage &= ~( 1 << song );
+	}
+	else if (fCurDue) {
+		Encode(REC_CUR, songCur, NULL, rgw);
+		WriteRec(pw, rgw);
+		songCurStored = songCur;
+	}
+	else {
+		Encode(REC_RESUME, modeResume, &preResume, rgw);
+		if (WriteRec(pw, rgw))
+			pwResume = pw;
+		fResumeStage = fFalse;
+	}
+	return fTrue;
+}
+
+//no name, and nothing staged if it is what flash already holds
+void PresetSetResume(const struct preset *ppre, WORD mode)
+{
+	struct preset	pre;
+	WORD	modeStored;
+
+	if (PresetGetResume(&pre, &modeStored) && modeStored == mode &&
+			pre.bpm == ppre->bpm && pre.meter == ppre->meter && pre.feel == ppre->feel)
+		return;
+
+	preResume = *ppre;
+	preResume.szName[0] = '\0';
+	modeResume = mode & 0xFF;
+	fResumeStage = fTrue;
+}
+
+BOOL PresetGetResume(struct preset *ppre, WORD *pmode)
+{
+	if (fResumeStage) {
+		*ppre = preResume;
+		*pmode = modeResume;
+		return fTrue;
+	}
+	if (pwResume == NULL)
+		return fFalse;
+	Decode(pwResume, ppre);
+	*pmode = ( pwResume[0] >> 16 ) & 0xFF;
+	return fTrue;
+}
+
+WORD PresetFree(void)
+{
+	return crecPage - irecNext;
+}
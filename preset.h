@@ -0,0 +1,82 @@
+/************************************************************************/
+/*																		*/
+/*	preset.h -- Setlist presets kept in program flash					*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	A setlist of PRESET_SONGS songs, each a name, a tempo and the		*/
+/*	meter and feel choices of the front panel, survives power-down		*/
+/*	in two reserved pages of program flash.  Nothing is ever			*/
+/*	rewritten in place: every save appends a 16-byte record to the		*/
+/*	active page, so a page takes 255 saves per erase.  When it runs		*/
+/*	low, the live records are copied to the other page, which only		*/
+/*	then gets its header and becomes the active page.  A power cut at	*/
+/*	any point leaves one of the pages valid.							*/
+/*																		*/
+/*	PresetInit() scans the active page once and keeps a pointer to		*/
+/*	the newest record of each song, so recalling a song is a lookup.	*/
+/*	Saves are staged in RAM and written by PresetTask() in the I/O		*/
+/*	window after a beat (sched.h), since the CPU stalls while flash		*/
+/*	is programmed, and only when no beat engine interrupt is due		*/
+/*	before the write is done.  A page erase stalls it far longer, so	*/
+/*	pages are swapped at boot, or when one fills up once the beat is	*/
+/*	stopped, never while it runs.  The current song is written once		*/
+/*	it has stayed selected a while, not on every step.					*/
+/*																		*/
+/*	One more record holds the state to resume with at power-up: the		*/
+/*	tempo, meter and feel playing and the front panel mode.  It is		*/
+/*	only restaged when that state differs from what flash holds.		*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_PRESET_INC)
+#define _PRESET_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	PRESET_SONGS		16
+#define	PRESET_NAME			8			// characters, no terminator in flash
+#define	PRESET_NONE			0xFF		// no song recalled yet
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+struct preset {
+	char	szName[PRESET_NAME + 1];
+	HWORD	bpm;
+	BYTE	meter;			// front panel meter / polyrhythm choice
+	BYTE	feel;			// front panel subdivision and swing choice
+};
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+//index the store; swaps pages first if the active one is running low
+void	PresetInit(void);
+//song slot, or "Song n" at 120 BPM if it was never saved; fTrue if saved
+BOOL	PresetGet(WORD song, struct preset *ppre);
+//staged now, written by PresetTask()
+void	PresetSave(WORD song, const struct preset *ppre);
+//the song in use, remembered for the next power-up
+void	PresetSetCurrent(WORD song);
+WORD	PresetGetCurrent(void);
+//writes staged records in the I/O window; fFalse while the page is
+// full and saves wait for the beat to stop
+BOOL	PresetTask(WORD tmsNow);
+//what is playing, for the next power-up
+void	PresetSetResume(const struct preset *ppre, WORD mode);
+//fTrue if there is one; no name
+BOOL	PresetGetResume(struct preset *ppre, WORD *pmode);
+//records left in the active page
+WORD	PresetFree(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
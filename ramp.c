@@ -0,0 +1,210 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-practice tempo ramps, moved on one bar line at a time from   *
+ *				 the beat interrupt.                                          *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "beat.h"
+#include "ramp.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+// beat ticks per minute times 16: one 32-bit divide turns a Q16 BPM
+// with its low 12 bits dropped into a period, or back
+#define		TICKS_PER_MIN_Q4	( (WORD)BEAT_TICKS_PER_MIN * 16 )
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct ramp {
+	WORD	kind;
+	WORD	bpmTarget;
+	WORD	periodTarget;
+	WORD	cbar;			// RAMP_STEP: bars between steps
+	WORD	cbarLeft;		// to the next step, or to the target
+	WORD	q;				// BPM in Q16, or for RAMP_EXP the period in Q8
+	int		dq;				// added to q each step, or for RAMP_EXP the Q16 ratio
+	WORD	periodSet;		// what the last bar line asked for
+	BOOL	fUp;			// getting faster
+	BOOL	fRun;
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static const char * const rgszRamp[RAMP_KINDS] = {
+	"off", "stp", "lin", "exp" };
+
+static struct ramp	rampCur;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static WORD BpmQ16(WORD period)
+{
+	return ( TICKS_PER_MIN_Q4 / period ) << 12;
+}
+
+static WORD PeriodFromQ16(WORD bpmQ16)
+{
+	return TICKS_PER_MIN_Q4 / ( bpmQ16 >> 12 );
+}
+
+//Q16 ratio r with period * r^cbar at or just past periodTarget, by
+// bisection, running the same multiplies RampBar() will.  Main loop only.
+static WORD ExpRatio(WORD period, WORD periodTarget, WORD cbar)
+{
+	WORD	lo;
+	WORD	hi;
+	WORD	r;
+	WORD	q;
+	WORD	ibar;
+
+	if (periodTarget < period) {
+		lo = ( (DWORD)periodTarget << 16 ) / period;
+		hi = 1 << 16;
+	}
+	else {
+		lo = 1 << 16;
+		hi = ( (DWORD)periodTarget << 16 ) / period;
+	}
+
+	while (hi - lo > 1) {
+		r = ( lo + hi ) / 2;
+		q = period << 8;
+		for (ibar = 0; ibar < cbar; ibar++)
+			q = ( (DWORD)q * r ) >> 16;
+		if (q < ( periodTarget << 8 ))
+			lo = r;
+		else
+			hi = r;
+	}
+	return hi;
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void RampInit(void)
+{
+	rampCur.kind = RAMP_OFF;
+	rampCur.fRun = fFalse;
+}
+
+void RampStart(WORD kind, WORD bpmTarget, WORD dbpm, WORD cbar)
+{
+	struct ramp	ramp;
+	unsigned int intStat;
+	WORD	period = BeatGetPeriodNext();
+
+	if (kind >= RAMP_KINDS || kind == RAMP_OFF || period == 0) {
+		RampStop();
+		return;
+	}
+	if (cbar == 0)
+		cbar = 1;
+
+	ramp.kind = kind;
+	ramp.bpmTarget = bpmTarget;
+	ramp.periodTarget = BeatBpmToPeriod(bpmTarget);
+	ramp.cbar = cbar;
+	ramp.cbarLeft = cbar;
+	ramp.periodSet = period;
+	ramp.fUp = ( ramp.periodTarget < period );
+	ramp.fRun = ( ramp.periodTarget != period );
+
+	switch (kind) {
+		case RAMP_STEP:
+			ramp.q = BpmQ16(period);
+			ramp.dq = ramp.fUp ? (int)( dbpm << 16 ) : -(int)( dbpm << 16 );
+			break;
+		case RAMP_LINEAR:
+			ramp.q = BpmQ16(period);
+			ramp.dq = (int)( BpmQ16(ramp.periodTarget) - ramp.q ) / (int)cbar;
+			break;
+		case RAMP_EXP:
+			ramp.q = period << 8;
+			ramp.dq = ExpRatio(period, ramp.periodTarget, cbar);
+			break;
+	}
+
+	intStat = INTDisableInterrupts();
+	rampCur = ramp;
+	INTRestoreInterrupts(intStat);
+}
+
+void RampStop(void)
+{
+	rampCur.fRun = fFalse;
+	rampCur.kind = RAMP_OFF;
+}
+
+WORD RampGetKind(void)
+{
+	return rampCur.kind;
+}
+
+WORD RampGetTarget(void)
+{
+	return rampCur.bpmTarget;
+}
+
+BOOL RampRunning(void)
+{
+	return rampCur.fRun;
+}
+
+const char * RampName(WORD kind)
+{
+	return ( kind < RAMP_KINDS ) ? rgszRamp[kind] : "";
+}
+
+//One add (or one multiply and shift) and one divide per bar.  The
+// last bar, or a step past the target, lands exactly on the target.
+void RampBar(void)
+{
+	struct ramp	*pramp = &rampCur;
+	WORD	period;
+	BOOL	fEnd = fFalse;
+
+	if (!pramp->fRun)
+		return;
+
+	// someone else moved the tempo: go on from there
+	period = BeatGetPeriodNext();
+	if (period != pramp->periodSet)
+		pramp->q = ( pramp->kind == RAMP_EXP ) ? period << 8 : BpmQ16(period);
+
+	switch (pramp->kind) {
+		case RAMP_STEP:
+			if (--pramp->cbarLeft != 0)
+				return;
+			pramp->cbarLeft = pramp->cbar;
+			pramp->q += pramp->dq;
+			break;
+		case RAMP_LINEAR:
+			pramp->q += pramp->dq;
+			fEnd = ( --pramp->cbarLeft == 0 );
+			break;
+		case RAMP_EXP:
+			pramp->q = ( (DWORD)pramp->q * (WORD)pramp->dq ) >> 16;
+			fEnd = ( --pramp->cbarLeft == 0 );
+			break;
+	}
+
+	period = ( pramp->kind == RAMP_EXP ) ? pramp->q >> 8 : PeriodFromQ16(pramp->q);
+	if (pramp->fUp ? period <= pramp->periodTarget : period >= pramp->periodTarget)
+		fEnd = fTrue;
+	if (fEnd) {
+		period = pramp->periodTarget;
+		pramp->fRun = fFalse;
+	}
+
+	pramp->periodSet = period;
+	BeatSetPeriod(period);
+}
@@ -0,0 +1,61 @@
+/************************************************************************/
+/*																		*/
+/*	ramp.h -- Practice tempo ramps										*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	A ramp moves the tempo from where it is to a target, one bar line	*/
+/*	at a time, and then holds it there:									*/
+/*																		*/
+/*	  RAMP_STEP		dbpm BPM up (or down) every cbar bars				*/
+/*	  RAMP_LINEAR	the same BPM change each bar, target after cbar		*/
+/*	  RAMP_EXP		the period times the same ratio each bar, target	*/
+/*					after cbar; equal musical steps, gentle at the top	*/
+/*																		*/
+/*	The beat engine calls RampBar() from the Timer2 interrupt at each	*/
+/*	bar line.  The state is a running value in fixed point (BPM in		*/
+/*	Q16 for the first two, the period in Q8 for the exponential one)	*/
+/*	that each bar line moves on by one add or one multiply.  If the		*/
+/*	tempo is changed by anything else, the ramp carries on from there.	*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_RAMP_INC)
+#define _RAMP_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	RAMP_OFF			0
+#define	RAMP_STEP			1
+#define	RAMP_LINEAR			2
+#define	RAMP_EXP			3
+#define	RAMP_KINDS			4
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	RampInit(void);
+//from the current tempo, starting at the next bar line.  dbpm is only
+// used by RAMP_STEP; cbar is its step interval or the other kinds'
+// length in bars
+void	RampStart(WORD kind, WORD bpmTarget, WORD dbpm, WORD cbar);
+void	RampStop(void);
+WORD	RampGetKind(void);
+WORD	RampGetTarget(void);
+//ramp set and the target not reached yet
+BOOL	RampRunning(void);
+//"stp", "lin", "exp"
+const char *	RampName(WORD kind);
+
+//beat engine, Timer2 ISR: a bar line, before the period for it is taken
+void	RampBar(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-watchdog service, and the beat snapshot kept across a        *
+ *				 watchdog reset in RAM the startup code leaves alone.         *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "rescue.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		bnWDTO				4			// RCON: watchdog time-out reset
+#define		bnWDTCLR			0			// WDTCON
+#define		RESCUE_MAGIC		0x52455343	// "RESC"
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+
+//not cleared or initialized at startup; garbage after power-up,
+// which the check catches
+static struct rescue	resKept __attribute__((persistent));
+static WORD		wCheckKept __attribute__((persistent));
+
+static struct rescue	resBoot;
+static BOOL		fRescue = fFalse;
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static WORD Check(const struct rescue *pres)
+{
+	const WORD	*pw = (const WORD *)pres;
+	WORD	w = RESCUE_MAGIC;
+	WORD	iw;
+
+	for (iw = 0; iw < sizeof(struct rescue) / sizeof(WORD); iw++)
+		w = ( ( w << 5 ) | ( w >> 27 ) ) ^ pw[iw];
+	return w;
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void RescueInit(void)
+{
+	RescueKick();
+
+	fRescue = ( RCON & ( 1 << bnWDTO ) ) && wCheckKept == Check(&resKept);
+	if (fRescue)
+		resBoot = resKept;
+
+	// used up: a second reset before the main loop runs again starts afresh
+	RCONCLR = ( 1 << bnWDTO );
+	wCheckKept = ~Check(&resKept);
+}
+
+BOOL RescueGet(struct rescue *pres)
+{
+	if (fRescue)
+		*pres = resBoot;
+	return fRescue;
+}
+
+void RescueSave(const struct rescue *pres)
+{
+	WDTCONSET = ( 1 << bnWDTCLR );
+	resKept = *pres;
+	wCheckKept = Check(&resKept);
+}
+
+void RescueKick(void)
+{
+	WDTCONSET = ( 1 << bnWDTCLR );
+}
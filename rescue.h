@@ -0,0 +1,65 @@
+/************************************************************************/
+/*																		*/
+/*	rescue.h -- Watchdog service and recovery of the running beat		*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	The watchdog is on from reset (configuration bits, WDTPS = PS64),	*/
+/*	so a main loop stuck in a wait resets the part RESCUE_WDT_US		*/
+/*	after it last got round.  Each pass of the main loop clears the		*/
+/*	watchdog and leaves a snapshot of the beat in RAM that the			*/
+/*	startup code does not clear.  After a watchdog reset the snapshot	*/
+/*	says where the beat was and the watchdog period roughly how long	*/
+/*	ago, so the click comes back on the same grid within a beat,		*/
+/*	without taps.  After any other reset it is ignored.					*/
+/*																		*/
+/*	Loops that wait on purpose, outside the main loop, call				*/
+/*	RescueKick() instead.												*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_RESCUE_INC)
+#define _RESCUE_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	RESCUE_WDT_US		64000		// WDTPS = PS64 on the 1 ms LPRC tick
+
+/* ------------------------------------------------------------ */
+/*					Object Class Declarations					*/
+/* ------------------------------------------------------------ */
+
+struct rescue {
+	WORD	period;			// beat ticks
+	WORD	tckSince;		// from the last beat to the snapshot
+	int		bar;			// bar number of the last beat as shown
+	HWORD	bpmTarget;		// ramp target
+	BYTE	beat;			// the last beat's place in the bar, from 0
+	BYTE	cbeat;			// beats in the bar
+	BYTE	meter;			// front panel choices, as in struct preset
+	BYTE	feel;
+	BYTE	mode;
+	BYTE	song;
+};
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+//first thing at boot: keeps the snapshot only after a watchdog reset
+void	RescueInit(void);
+//fTrue after a watchdog reset, with the last snapshot
+BOOL	RescueGet(struct rescue *pres);
+//clears the watchdog and keeps the snapshot
+void	RescueSave(const struct rescue *pres);
+//clears the watchdog only
+void	RescueKick(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
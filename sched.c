@@ -0,0 +1,85 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-beat-aware scheduling of slow I/O, and the click-onset delay *
+ *				 it is meant to keep down.                                    *
+ ******************************************************************************/
+
+#include "stdtypes.h"
+#include "beat.h"
+#include "poly.h"
+#include "sched.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static volatile BOOL	fPolicy = fTrue;
+static volatile HWORD	rgtckOnsetMax[2];	// [fPolicy]
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void SchedInit(void)
+{
+	fPolicy = fTrue;
+	SchedOnsetReset();
+}
+
+void SchedSetPolicy(BOOL fOn)
+{
+	fPolicy = fOn ? fTrue : fFalse;
+}
+
+BOOL SchedGetPolicy(void)
+{
+	return fPolicy;
+}
+
+//callable from the main loop and from interrupts below the beat's
+// priority level
+BOOL SchedIoWindow(void)
+{
+	WORD	tckSince;
+
+	if (!fPolicy || !BeatRunning())
+		return fTrue;
+
+	tckSince = BeatNow() - BeatLastBeat();
+	return tckSince >= BeatUsToTicks(SCHED_GAP_US) &&
+		tckSince < BeatGetPeriod() / 2;
+}
+
+//the beat engine and poly voices are the only interrupts with
+// deadlines; MIDI and audio have FIFOs and buffers that ride out a
+// short stall; with the policy off a write may land on a click
+BOOL SchedQuiet(WORD tus)
+{
+	WORD	tck;
+
+	if (!fPolicy)
+		return fTrue;
+
+	tck = BeatUsToTicks(tus);
+	return BeatTicksToNext() > tck && PolyTicksToNext() > tck;
+}
+
+void SchedClickOnset(WORD tck)
+{
+	volatile HWORD	*ptck = &rgtckOnsetMax[fPolicy];
+
+	if (tck > 0xFFFF)
+		tck = 0xFFFF;
+	if (tck > *ptck)
+		*ptck = tck;
+}
+
+WORD SchedOnsetMaxUs(BOOL fOn)
+{
+	return ( rgtckOnsetMax[fOn ? 1 : 0] * 2 + 4 ) / 5;
+}
+
+void SchedOnsetReset(void)
+{
+	rgtckOnsetMax[0] = 0;
+	rgtckOnsetMax[1] = 0;
+}
@@ -0,0 +1,59 @@
+/************************************************************************/
+/*																		*/
+/*	sched.h -- Beat-aware slot for slow I/O								*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	LCD writes block on the controller's busy flag and a battery		*/
+/*	burst loads the supply while the LEDs are lit.  Neither is urgent,	*/
+/*	so they wait for the guard window: from SCHED_GAP_US after a beat	*/
+/*	(blip and beat LEDs done) to half way to the next one.  Code that	*/
+/*	does slow I/O asks SchedIoWindow() first and tries again later		*/
+/*	if it says no.  With the beat stopped the window is always open.	*/
+/*																		*/
+/*	To see what the policy buys, the beat and polyrhythm interrupts		*/
+/*	report how long after its scheduled tick each click's sample		*/
+/*	clock actually started, and the worst case is kept separately for	*/
+/*	clicks played with the policy on and with it off.  That covers		*/
+/*	everything that can hold a click back: interrupt latency, the		*/
+/*	handler's own work, and flash writes and other code in the main		*/
+/*	loop that stalls the CPU or masks interrupts.						*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_SCHED_INC)
+#define _SCHED_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	SCHED_GAP_US		10000
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	SchedInit(void);
+//off: slow I/O goes out whenever it comes up, for comparison
+void	SchedSetPolicy(BOOL fOn);
+BOOL	SchedGetPolicy(void);
+//slow I/O may start now
+BOOL	SchedIoWindow(void);
+//no beat, pulse or poly interrupt is due for tus: a CPU stall (flash
+// programming) that short holds no click back; always fTrue with the
+// policy off
+BOOL	SchedQuiet(WORD tus);
+
+//beat and poly ISRs: a click's sound started tck after its tick
+void	SchedClickOnset(WORD tck);
+//worst click-onset delay in us with the policy on (fTrue) or off
+WORD	SchedOnsetMaxUs(BOOL fPolicy);
+void	SchedOnsetReset(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
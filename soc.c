@@ -0,0 +1,125 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-state-of-charge estimate.  Looks the load-compensated cell   *
+ *				 voltage up in a per-chemistry discharge curve instead of     *
+ *				 the old linear readADC(8)/4 - 6 formula.                     *
+ ******************************************************************************/
+
+#include "stdtypes.h"
+#include "battery.h"
+#include "soc.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct chem {
+	const HWORD	*pmv;		// cell mV at 0, 10, ... 100 % charge
+	BYTE		cells;
+	HWORD		sagMv;		// pack sag per lit LED
+	HWORD		mAh;		// rated capacity
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+// per-cell discharge curves at moderate load
+static const HWORD rgmvAlkaline[SOC_POINTS] = {
+	1000, 1100, 1150, 1180, 1210, 1240, 1270, 1300, 1340, 1400, 1550 };
+static const HWORD rgmvNimh[SOC_POINTS] = {
+	1000, 1100, 1160, 1190, 1210, 1230, 1250, 1270, 1290, 1320, 1400 };
+static const HWORD rgmvLipo[SOC_POINTS] = {
+	3300, 3500, 3600, 3680, 3740, 3790, 3830, 3890, 3970, 4070, 4200 };
+
+static const struct chem rgchem[SOC_CHEMISTRIES] = {
+	{ rgmvAlkaline,	4, 40, 2500 },	// SOC_ALKALINE: high internal resistance
+	{ rgmvNimh,		4, 15, 2000 },	// SOC_NIMH
+	{ rgmvLipo,		2, 10, 1000 },	// SOC_LIPO
+};
+
+static const struct chem *pchem = &rgchem[SOC_ALKALINE];
+static WORD		socSeg = 0;			// curve segment [socSeg, socSeg + 1]
+static WORD		socQ8 = 0;
+static WORD		socPackMv = 0;
+static WORD		socBursts = 0;		// last battBursts value seen
+static BOOL		fSocSeeded = fFalse;
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void SocInit(WORD chem)
+{
+	if (chem >= SOC_CHEMISTRIES)
+		chem = SOC_ALKALINE;
+	pchem = &rgchem[chem];
+	socSeg = 0;
+	socQ8 = 0;
+	fSocSeeded = fFalse;
+	socBursts = battBursts - 1;		// force an update on the next task call
+}
+
+//one update per battery burst.  The segment index moves at most one
+// step per call except on the first reading, so the cost per refresh
+// is constant; the battery voltage never moves faster than that.
+void SocTask(void)
+{
+	const HWORD	*pmv = pchem->pmv;
+	WORD	cellMv;
+	WORD	lo;
+	WORD	hi;
+
+	if (!BattReady() || socBursts == battBursts)
+		return;
+	socBursts = battBursts;
+
+	// 12-bit counts -> pack mV, then add back the LED sag
+	socPackMv = ( (WORD)BattGetLevel() * BATT_VREF_MV * BATT_DIVIDER ) >> 12;
+	socPackMv += ( battLoad * pchem->sagMv ) >> 8;
+	cellMv = socPackMv / pchem->cells;
+
+	if (!fSocSeeded) {
+		socSeg = 0;
+		while (socSeg < SOC_POINTS - 2 && cellMv > pmv[socSeg + 1])
+			socSeg++;
+		fSocSeeded = fTrue;
+	}
+	else if (socSeg > 0 && cellMv < pmv[socSeg])
+		socSeg--;
+	else if (socSeg < SOC_POINTS - 2 && cellMv > pmv[socSeg + 1])
+		socSeg++;
+
+	lo = pmv[socSeg];
+	hi = pmv[socSeg + 1];
+	if (cellMv < lo)
+		cellMv = lo;
+	if (cellMv > hi)
+		cellMv = hi;
+
+	// 10 % per segment, interpolated in percent * 256
+	socQ8 = ( socSeg * 10 << 8 ) + ( ( cellMv - lo ) * ( 10 << 8 ) ) / ( hi - lo );
+}
+
+BOOL SocValid(void)
+{
+	return fSocSeeded;
+}
+
+WORD SocGetPercentQ8(void)
+{
+	return socQ8;
+}
+
+WORD SocGetPercent(void)
+{
+	return ( socQ8 + 128 ) >> 8;
+}
+
+WORD SocGetPackMv(void)
+{
+	return socPackMv;
+}
+
+WORD SocGetRemainingMah(void)
+{
+	return ( pchem->mAh * socQ8 ) / ( 100 << 8 );
+}
@@ -0,0 +1,51 @@
+/************************************************************************/
+/*																		*/
+/*	soc.h -- Battery state-of-charge estimation							*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Turns the smoothed battery reading into a charge percentage using	*/
+/*	a piecewise-linear per-cell discharge curve for the selected		*/
+/*	chemistry.  The reading is compensated for the sag caused by lit	*/
+/*	LEDs.  All math is fixed point (percent * 256).  SocTask() only		*/
+/*	does work when a new battery burst has arrived, and moves at most	*/
+/*	one curve segment per call.											*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_SOC_INC)
+#define _SOC_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Miscellaneous Declarations					*/
+/* ------------------------------------------------------------ */
+
+#define	SOC_ALKALINE		0		// 4 x AA alkaline
+#define	SOC_NIMH			1		// 4 x AA NiMH
+#define	SOC_LIPO			2		// 2S lithium polymer
+#define	SOC_CHEMISTRIES		3
+
+#define	SOC_POINTS			11		// curve points at 0, 10, ... 100 %
+
+#define	BATT_VREF_MV		3300	// AVdd reference
+#define	BATT_DIVIDER		3		// pack voltage divider on AN8
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	SocInit(WORD chem);
+void	SocTask(void);
+
+BOOL	SocValid(void);				// a battery reading has been used
+WORD	SocGetPercent(void);		// 0..100
+WORD	SocGetPercentQ8(void);		// percent * 256
+WORD	SocGetPackMv(void);			// load-compensated pack voltage
+WORD	SocGetRemainingMah(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
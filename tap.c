@@ -0,0 +1,125 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-tap-along tracking.  Taps during playback steer the beat     *
+ *				 engine's phase and period a little at a time.                *
+ ******************************************************************************/
+
+#include <plib.h>
+#include "stdtypes.h"
+#include "beat.h"
+#include "tap.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		bnCS0				1			// IFS0/IEC0: core software interrupt 0
+
+// A player's taps scatter by 10-20 ms, so the loop is slow: each tap
+// moves the beat a quarter of the way to it, and the period an eighth
+// of the way to the player's own tap interval.  Taps more than
+// TAP_GAP_BEATS apart say nothing about the tempo.
+#define		TAP_PHASE_DIV		4
+#define		TAP_PERIOD_DIV		8
+#define		TAP_GAP_BEATS		4
+
+/* ------------------------------------------------------------ */
+/*				Local Variables									*/
+/* ------------------------------------------------------------ */
+static volatile BOOL	fTracking = fFalse;
+static volatile WORD	tckTap = 0;
+static volatile int		tckTapErr = 0;
+static WORD		tckTapPrev = 0;		// last accepted tap, handler only
+static BOOL		fTapPrev = fFalse;
+
+/* ------------------------------------------------------------ */
+/*				Interrupt Service Routines						*/
+/* ------------------------------------------------------------ */
+
+//Tap event: constant time, a handful of adds and a few divides.
+// The beat ISR can come in here, so the beat time and period are read
+// together.
+void __ISR(_CORE_SOFTWARE_0_VECTOR, ipl4) TapHandler(void)
+{
+	unsigned int intStat;
+	WORD	period;
+	WORD	tckBeat;
+	WORD	interval;
+	WORD	cbeat;
+	int		err;
+
+	IFS0CLR = ( 1 << bnCS0 );
+
+	intStat = INTDisableInterrupts();
+	period = BeatGetPeriod();
+	tckBeat = BeatLastBeat();
+	INTRestoreInterrupts(intStat);
+
+	if (!fTracking || period == 0)
+		return;
+
+	// against the nearest beat: a tap just before a beat is early.
+	// It is handed over once the press turns out to be a tap, which
+	// can be after the next beat, so the offset is modulo the period.
+	err = (int)( tckTap - tckBeat ) % (int)period;
+	if (err >= (int)( period / 2 ))
+		err -= period;
+	else if (err < -(int)( period / 2 ))
+		err += period;
+	if (err > (int)( period / 4 ) || err < -(int)( period / 4 )) {
+		fTapPrev = fFalse;
+		return;
+	}
+
+	tckTapErr = err;
+	BeatShift(err / TAP_PHASE_DIV);
+
+	// the period follows the interval between taps, not their phase
+	interval = tckTap - tckTapPrev;
+	cbeat = ( interval + period / 2 ) / period;
+	if (fTapPrev && cbeat >= 1 && cbeat <= TAP_GAP_BEATS)
+		BeatSetPeriod(period + ( (int)( interval - cbeat * period ) / (int)cbeat ) / TAP_PERIOD_DIV);
+	tckTapPrev = tckTap;
+	fTapPrev = fTrue;
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+void TapInit(void)
+{
+	fTracking = fFalse;
+
+	// core software interrupt 0, priority level 4
+	IPC0CLR = ( 7 << 10 ) | ( 3 << 8 );
+	IPC0SET = ( 4 << 10 );
+	IFS0CLR = ( 1 << bnCS0 );
+	IEC0SET = ( 1 << bnCS0 );
+}
+
+void TapSetTracking(BOOL fOn)
+{
+	fTracking = fOn;
+	fTapPrev = fFalse;
+}
+
+BOOL TapGetTracking(void)
+{
+	return fTracking;
+}
+
+//the correction itself waits for the software interrupt, so the
+// caller spends no time on it
+void TapPress(WORD tck)
+{
+	if (!fTracking)
+		return;
+
+	tckTap = tck;
+	IFS0SET = ( 1 << bnCS0 );
+}
+
+int TapLastErrorUs(void)
+{
+	return ( tckTapErr * 2 ) / 5;
+}
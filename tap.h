@@ -0,0 +1,39 @@
+/************************************************************************/
+/*																		*/
+/*	tap.h -- Tap-along tempo tracking									*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	While the metronome runs, each short press of the tap button on		*/
+/*	its own (not part of a chord or a long press, gesture.h) is handed	*/
+/*	with the time it started to an event handler on core software		*/
+/*	interrupt 0.  The handler moves the beat phase a fraction of the	*/
+/*	way to the tap, and the period a fraction of the way to the			*/
+/*	interval between taps, like a PLL, so a drummer can pull the		*/
+/*	click around without stopping it.  Taps far from any beat (more		*/
+/*	than a quarter beat off) are ignored.								*/
+/*																		*/
+/************************************************************************/
+
+#if !defined(_TAP_INC)
+#define _TAP_INC
+
+#include "stdtypes.h"
+
+/* ------------------------------------------------------------ */
+/*					Procedure Declarations						*/
+/* ------------------------------------------------------------ */
+
+void	TapInit(void);
+void	TapSetTracking(BOOL fOn);
+BOOL	TapGetTracking(void);
+//a tap that started at BeatNow() time tck, handed over once the
+// gesture layer has it as a short press
+void	TapPress(WORD tck);
+//signed offset of the last accepted tap from its beat, in us (+ late)
+int		TapLastErrorUs(void);
+
+/* ------------------------------------------------------------ */
+
+#endif
@@ -0,0 +1,270 @@
+/******************************************************************************
+ * Project:		Metronome/Battery life display                                *
+ * Notes:		-host tool: converts WAV files into an IMA-ADPCM sample bank  *
+ *				 (see adpcm.h) and writes it out as bank.c.                   *
+ *																			  *
+ *	build:	cc -I.. -o wav2bank wav2bank.c ../adpcm.c						  *
+ *	use:	wav2bank [-r rate] bank.c click.wav accent.wav ...				  *
+ *																			  *
+ *	The source waves for bank.c are in tools/wav; the command that made		  *
+ *	it is in its header.  The file names go into the bank.c header as		  *
+ *	given, so run it from there.											  *
+ *																			  *
+ *	Input can be 8- or 16-bit PCM, mono or stereo, any sample rate; it is	  *
+ *	mixed to mono and linearly resampled to the playback rate (7987 Hz,		  *
+ *	the audio engine's Timer4 rate, unless -r says otherwise).				  *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stdtypes.h"
+#include "adpcm.h"
+
+/* ------------------------------------------------------------ */
+/*				Local Type Definitions							*/
+/* ------------------------------------------------------------ */
+#define		RATE_DEFAULT		7987
+#define		MAX_SAMPLES			16
+
+/* ------------------------------------------------------------ */
+/*				Local Structures								*/
+/* ------------------------------------------------------------ */
+struct pcm {
+	int16_t		*ps;
+	WORD		cs;
+	int16_t		pred0;
+	BYTE		idx0;
+	BYTE		*pb;		// ADPCM codes
+	WORD		cb;
+};
+
+/* ------------------------------------------------------------ */
+/*				Local Procedures								*/
+/* ------------------------------------------------------------ */
+
+static WORD Rd16(const BYTE *pb)
+{
+	return pb[0] | ( pb[1] << 8 );
+}
+
+static WORD Rd32(const BYTE *pb)
+{
+	return Rd16(pb) | ( Rd16(pb + 2) << 16 );
+}
+
+static void Die(const char *szMsg, const char *szArg)
+{
+	fprintf(stderr, "wav2bank: %s %s\n", szMsg, szArg ? szArg : "");
+	exit(1);
+}
+
+//load a PCM WAV, mix to mono and resample to rate
+static void LoadWav(const char *szFile, WORD rate, struct pcm *ppcm)
+{
+	FILE	*pf;
+	BYTE	*pb;
+	long	cb;
+	long	off;
+	WORD	chans = 0;
+	WORD	rateIn = 0;
+	WORD	bits = 0;
+	const BYTE	*pbData = NULL;
+	WORD	cbData = 0;
+	WORD	cfr;
+	float	*pfl;
+	WORD	i;
+	WORD	c;
+
+	if ((pf = fopen(szFile, "rb")) == NULL)
+		Die("can't open", szFile);
+	fseek(pf, 0, SEEK_END);
+	cb = ftell(pf);
+	fseek(pf, 0, SEEK_SET);
+	pb = malloc(cb);
+	if (pb == NULL || fread(pb, 1, cb, pf) != (size_t)cb)
+		Die("can't read", szFile);
+	fclose(pf);
+
+	if (cb < 12 || memcmp(pb, "RIFF", 4) || memcmp(pb + 8, "WAVE", 4))
+		Die("not a WAV file:", szFile);
+
+	for (off = 12; off + 8 <= cb; off += 8 + ( ( Rd32(pb + off + 4) + 1 ) & ~1 )) {
+		WORD	cbChunk = Rd32(pb + off + 4);
+
+		if (!memcmp(pb + off, "fmt ", 4)) {
+			if (Rd16(pb + off + 8) != 1)
+				Die("not PCM:", szFile);
+			chans = Rd16(pb + off + 10);
+			rateIn = Rd32(pb + off + 12);
+			bits = Rd16(pb + off + 22);
+		}
+		else if (!memcmp(pb + off, "data", 4)) {
+			pbData = pb + off + 8;
+			cbData = cbChunk;
+			if (pbData + cbData > pb + cb)
+				cbData = pb + cb - pbData;
+		}
+	}
+	if (pbData == NULL || chans == 0 || rateIn == 0 || ( bits != 8 && bits != 16 ))
+		Die("unsupported WAV format:", szFile);
+
+	// mix to mono floats
+	cfr = cbData / ( chans * bits / 8 );
+	pfl = malloc(( cfr + 1 ) * sizeof(float));
+	for (i = 0; i < cfr; i++) {
+		float	sum = 0;
+		for (c = 0; c < chans; c++) {
+			const BYTE	*pbS = pbData + ( i * chans + c ) * bits / 8;
+			sum += ( bits == 8 ) ? ( *pbS - 128 ) * 256.0f : (int16_t)Rd16(pbS);
+		}
+		pfl[i] = sum / chans;
+	}
+	pfl[cfr] = 0;
+
+	// linear resampling
+	ppcm->cs = (WORD)( (double)cfr * rate / rateIn );
+	ppcm->ps = malloc(( ppcm->cs + 1 ) * sizeof(int16_t));
+	for (i = 0; i < ppcm->cs; i++) {
+		double	pos = (double)i * rateIn / rate;
+		WORD	j = (WORD)pos;
+		double	frac = pos - j;
+		double	v = pfl[j] * ( 1.0 - frac ) + pfl[j + 1] * frac;
+
+		if (v > 32767)
+			v = 32767;
+		if (v < -32768)
+			v = -32768;
+		ppcm->ps[i] = (int16_t)v;
+	}
+
+	free(pfl);
+	free(pb);
+}
+
+//IMA-ADPCM encode; tracks the decoder so the predictor never drifts
+static void Encode(struct pcm *ppcm)
+{
+	int16_t	pred;
+	BYTE	idx = 0;
+	WORD	i;
+
+	ppcm->pred0 = pred = ppcm->cs ? ppcm->ps[0] : 0;
+	ppcm->idx0 = idx;
+	ppcm->cb = ( ppcm->cs + 1 ) / 2;
+	ppcm->pb = calloc(ppcm->cb + 1, 1);
+
+	for (i = 0; i < ppcm->cs; i++) {
+		int		diff = ppcm->ps[i] - pred;
+		int		step = rgstepAdpcm[idx];
+		BYTE	nib = 0;
+
+		if (diff < 0) {
+			nib = 8;
+			diff = -diff;
+		}
+		if (diff >= step) {
+			nib |= 4;
+			diff -= step;
+		}
+		step >>= 1;
+		if (diff >= step) {
+			nib |= 2;
+			diff -= step;
+		}
+		step >>= 1;
+		if (diff >= step)
+			nib |= 1;
+
+		pred = AdpcmNibble(pred, &idx, nib);
+		ppcm->pb[i / 2] |= ( i & 1 ) ? ( nib << 4 ) : nib;
+	}
+}
+
+static void Put16(BYTE *pb, WORD w)
+{
+	pb[0] = w & 0xFF;
+	pb[1] = ( w >> 8 ) & 0xFF;
+}
+
+static void Put32(BYTE *pb, WORD w)
+{
+	Put16(pb, w & 0xFFFF);
+	Put16(pb + 2, w >> 16);
+}
+
+/* ------------------------------------------------------------ */
+/*				Procedure Definitions							*/
+/* ------------------------------------------------------------ */
+
+int main(int argc, char *argv[])
+{
+	struct pcm	rgpcm[MAX_SAMPLES];
+	WORD	rate = RATE_DEFAULT;
+	WORD	cpcm;
+	WORD	cbBank;
+	WORD	off;
+	WORD	csTotal = 0;
+	BYTE	*pbBank;
+	FILE	*pf;
+	int		iarg = 1;
+	WORD	i;
+
+	if (argc > 2 && !strcmp(argv[1], "-r")) {
+		rate = atoi(argv[2]);
+		iarg = 3;
+	}
+	if (argc - iarg < 2 || rate == 0)
+		Die("usage: wav2bank [-r rate] bank.c file.wav ...", NULL);
+
+	cpcm = argc - iarg - 1;
+	if (cpcm > MAX_SAMPLES)
+		Die("too many samples", NULL);
+
+	cbBank = ADPCM_HDR_SIZE + cpcm * ADPCM_ENT_SIZE;
+	for (i = 0; i < cpcm; i++) {
+		LoadWav(argv[iarg + 1 + i], rate, &rgpcm[i]);
+		Encode(&rgpcm[i]);
+		cbBank += rgpcm[i].cb;
+		csTotal += rgpcm[i].cs;
+	}
+
+	pbBank = calloc(cbBank, 1);
+	memcpy(pbBank, "MBNK", 4);
+	Put16(pbBank + 4, ADPCM_VERSION);
+	Put16(pbBank + 6, cpcm);
+	Put16(pbBank + 8, rate);
+
+	off = ADPCM_HDR_SIZE + cpcm * ADPCM_ENT_SIZE;
+	for (i = 0; i < cpcm; i++) {
+		BYTE	*pbEnt = pbBank + ADPCM_HDR_SIZE + i * ADPCM_ENT_SIZE;
+
+		Put32(pbEnt, off);
+		Put32(pbEnt + 4, rgpcm[i].cs);
+		Put16(pbEnt + 8, (HWORD)rgpcm[i].pred0);
+		pbEnt[10] = rgpcm[i].idx0;
+		memcpy(pbBank + off, rgpcm[i].pb, rgpcm[i].cb);
+		off += rgpcm[i].cb;
+	}
+
+	if ((pf = fopen(argv[iarg], "w")) == NULL)
+		Die("can't write", argv[iarg]);
+
+	fprintf(pf, "/* Generated by tools/wav2bank -- do not edit.\n");
+	fprintf(pf, "** in tools/wav:");
+	for (i = 0; i < (WORD)argc; i++)
+		fprintf(pf, " %s", argv[i]);
+	fprintf(pf, "\n");
+	fprintf(pf, "** %u Hz, %u bytes (%u bytes as 16-bit PCM):\n", rate, cbBank, csTotal * 2);
+	for (i = 0; i < cpcm; i++)
+		fprintf(pf, "**   %u: %s, %u samples\n", i, argv[iarg + 1 + i], rgpcm[i].cs);
+	fprintf(pf, "*/\n\n#include \"stdtypes.h\"\n#include \"adpcm.h\"\n\n");
+	fprintf(pf, "const BYTE rgbBank[%u] = {", cbBank);
+	for (i = 0; i < cbBank; i++)
+		fprintf(pf, "%s0x%02X%s", ( i % 12 ) ? " " : "\n\t", pbBank[i], ( i + 1 < cbBank ) ? "," : "");
+	fprintf(pf, " };\n");
+	fclose(pf);
+
+	printf("wav2bank: %u samples, %u bytes\n", cpcm, cbBank);
+	return 0;
+}